@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "ThreadPool.hpp"
+
+// Pool-aware synchronization. Instead of blocking the worker, a task hands the code that needs the resource
+// to these primitives as a continuation: it runs right away when the resource is free, otherwise it is parked
+// and re-enqueued on the pool once the resource frees up, while the worker goes on with other tasks.
+// Internal locks are only held for bookkeeping, never while a continuation runs.
+class AsyncPrimitives
+{
+    public:
+
+        // fast-path continuations run inline up to this nesting depth per thread, deeper ones go through the
+        // pool so a consumer that re-arms itself cannot grow the stack without bound
+        static constexpr uint32_t MAX_INLINE_DEPTH = 16u;
+
+        template<typename F> static void runOrPost(ThreadPool& pool, F&& func);
+
+        template<typename F> static void post(ThreadPool& pool, F&& func);
+
+    private:
+
+        inline static thread_local uint32_t s_inlineDepth = 0u;
+};
+
+// continuation taking an argument, parked inside a primitive
+template<typename Arg> struct AsyncCallback
+{
+    virtual void invoke(Arg&& arg) = 0;
+
+    virtual ~AsyncCallback() = default;
+
+    template<typename F> static std::unique_ptr<AsyncCallback> make(F&& func);
+};
+
+class AsyncSemaphore
+{
+    public:
+
+        AsyncSemaphore(ThreadPool& pool, uint32_t permits);
+
+        AsyncSemaphore(const AsyncSemaphore& other) = delete;
+
+        AsyncSemaphore& operator=(const AsyncSemaphore& other) = delete;
+
+        // continuation runs holding one permit, it (or anything after it) must release() it. Waiters are
+        // served first come first served and a released permit goes straight to the oldest one.
+        template<typename F> void acquire(F&& continuation);
+
+        bool tryAcquire();
+
+        void release(uint32_t count = 1u);
+
+        uint32_t available();
+
+    private:
+
+        ThreadPool* m_pool;
+
+        std::mutex m_mut;
+
+        uint32_t m_permits;
+
+        std::deque<ThreadPool::FunctionWrapper::Ptr> m_waiters;
+};
+
+class AsyncMutex
+{
+    public:
+
+        explicit AsyncMutex(ThreadPool& pool);
+
+        // continuation runs holding the mutex and must lead to an unlock()
+        template<typename F> void lock(F&& continuation);
+
+        bool tryLock();
+
+        void unlock();
+
+        // runs func holding the mutex and unlocks once it returns
+        template<typename F> void runLocked(F&& func);
+
+    private:
+
+        AsyncSemaphore m_semaphore;
+};
+
+// Bounded MPMC channel. A capacity of 0 makes every send a rendezvous with a receive.
+template<typename T> class AsyncChannel
+{
+    public:
+
+        AsyncChannel(ThreadPool& pool, size_t capacity);
+
+        AsyncChannel(const AsyncChannel& other) = delete;
+
+        AsyncChannel& operator=(const AsyncChannel& other) = delete;
+
+        // onSent(bool) runs once the value is buffered or handed to a receiver (true) or the channel got
+        // closed first (false)
+        template<typename F> void send(T value, F&& onSent);
+
+        // onValue(std::optional<T>) runs with the next value, or std::nullopt once the channel is closed and empty
+        template<typename F> void receive(F&& onValue);
+
+        bool trySend(T& value);
+
+        std::optional<T> tryReceive();
+
+        // pending senders fail, pending receivers get std::nullopt, buffered values can still be received
+        void close();
+
+        bool closed();
+
+    private:
+
+        struct ParkedSender
+        {
+            T value;
+
+            std::unique_ptr<AsyncCallback<bool>> onSent;
+        };
+
+        // moves a parked sender's value into the buffer, true if there was one; with the lock held
+        bool refillFromSender(std::unique_ptr<AsyncCallback<bool>>& outSender);
+
+        ThreadPool* m_pool;
+
+        size_t m_capacity;
+
+        std::mutex m_mut;
+
+        bool m_closed = false;
+
+        std::deque<T> m_buffer;
+
+        std::deque<ParkedSender> m_senders;
+
+        std::deque<std::unique_ptr<AsyncCallback<std::optional<T>>>> m_receivers;
+};
+
+#include "AsyncPrimitives.inl"
\ No newline at end of file
@@ -0,0 +1,359 @@
+#pragma once
+
+template<typename F> void AsyncPrimitives::runOrPost(ThreadPool& pool, F&& func)
+{
+    if(s_inlineDepth >= MAX_INLINE_DEPTH)
+    {
+        post(pool, std::forward<F>(func));
+
+        return;
+    }
+
+    ++s_inlineDepth;
+
+    func();
+
+    --s_inlineDepth;
+}
+
+template<typename F> void AsyncPrimitives::post(ThreadPool& pool, F&& func)
+{
+    // FunctionWrapper moves from its argument, hand it a prvalue
+    pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>(std::decay_t<F>{std::forward<F>(func)}));
+}
+
+template<typename Arg> template<typename F> std::unique_ptr<AsyncCallback<Arg>> AsyncCallback<Arg>::make(F&& func)
+{
+    struct Impl : public AsyncCallback<Arg>
+    {
+        std::decay_t<F> m_func;
+
+        Impl(std::decay_t<F>&& implFunc) : m_func{std::move(implFunc)} {}
+
+        void invoke(Arg&& arg) override { m_func(std::move(arg)); }
+    };
+
+    return std::make_unique<Impl>(std::decay_t<F>{std::forward<F>(func)});
+}
+
+inline AsyncSemaphore::AsyncSemaphore(ThreadPool& pool, uint32_t permits) : m_pool{&pool}, m_permits{permits}
+{
+}
+
+template<typename F> void AsyncSemaphore::acquire(F&& continuation)
+{
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        // no barging past parked waiters
+        if(m_permits == 0u || !m_waiters.empty())
+        {
+            m_waiters.push_back(std::make_unique<ThreadPool::FunctionWrapper>(std::decay_t<F>{std::forward<F>(continuation)}));
+
+            return;
+        }
+
+        --m_permits;
+    }
+
+    AsyncPrimitives::runOrPost(*m_pool, std::forward<F>(continuation));
+}
+
+inline bool AsyncSemaphore::tryAcquire()
+{
+    std::lock_guard<std::mutex> lk{m_mut};
+
+    if(m_permits == 0u || !m_waiters.empty())
+    {
+        return false;
+    }
+
+    --m_permits;
+
+    return true;
+}
+
+inline void AsyncSemaphore::release(uint32_t count)
+{
+    std::deque<ThreadPool::FunctionWrapper::Ptr> resumed;
+
+    ThreadPool& pool = *m_pool;
+
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        for(; count != 0u && !m_waiters.empty(); --count)
+        {
+            resumed.push_back(std::move(m_waiters.front()));
+
+            m_waiters.pop_front();
+        }
+
+        m_permits += count;
+    }
+
+    for(auto& waiter : resumed)
+    {
+        pool.executeAsync(std::move(waiter));
+    }
+}
+
+inline uint32_t AsyncSemaphore::available()
+{
+    std::lock_guard<std::mutex> lk{m_mut};
+
+    return m_permits;
+}
+
+inline AsyncMutex::AsyncMutex(ThreadPool& pool) : m_semaphore{pool, 1u}
+{
+}
+
+template<typename F> void AsyncMutex::lock(F&& continuation)
+{
+    m_semaphore.acquire(std::forward<F>(continuation));
+}
+
+inline bool AsyncMutex::tryLock()
+{
+    return m_semaphore.tryAcquire();
+}
+
+inline void AsyncMutex::unlock()
+{
+    m_semaphore.release();
+}
+
+template<typename F> void AsyncMutex::runLocked(F&& func)
+{
+    lock([this, func = std::decay_t<F>{std::forward<F>(func)}]() mutable -> void
+    {
+        func();
+
+        unlock();
+    });
+}
+
+template<typename T> AsyncChannel<T>::AsyncChannel(ThreadPool& pool, size_t capacity) : m_pool{&pool}, m_capacity{capacity}
+{
+}
+
+template<typename T> template<typename F> void AsyncChannel<T>::send(T value, F&& onSent)
+{
+    std::unique_ptr<AsyncCallback<std::optional<T>>> receiver;
+
+    bool sent = false;
+
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        if(!m_closed)
+        {
+            if(!m_receivers.empty())
+            {
+                // a parked receiver means the buffer is empty, the value goes straight to it
+                receiver = std::move(m_receivers.front());
+
+                m_receivers.pop_front();
+
+                sent = true;
+            }
+            else if(m_buffer.size() < m_capacity)
+            {
+                m_buffer.push_back(std::move(value));
+
+                sent = true;
+            }
+            else
+            {
+                m_senders.push_back(ParkedSender{std::move(value), AsyncCallback<bool>::make(std::forward<F>(onSent))});
+
+                return;
+            }
+        }
+    }
+
+    // a resumed continuation may end up destroying the channel, no members past this point
+    ThreadPool& pool = *m_pool;
+
+    if(receiver != nullptr)
+    {
+        AsyncPrimitives::post(pool, [receiver = std::move(receiver), value = std::move(value)]() mutable -> void
+        {
+            receiver->invoke(std::optional<T>{std::move(value)});
+        });
+    }
+
+    AsyncPrimitives::runOrPost(pool, [onSent = std::decay_t<F>{std::forward<F>(onSent)}, sent]() mutable -> void { onSent(sent); });
+}
+
+template<typename T> template<typename F> void AsyncChannel<T>::receive(F&& onValue)
+{
+    std::optional<T> value;
+
+    std::unique_ptr<AsyncCallback<bool>> sender;
+
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        if(!m_buffer.empty())
+        {
+            value.emplace(std::move(m_buffer.front()));
+
+            m_buffer.pop_front();
+
+            refillFromSender(sender);
+        }
+        else if(!m_senders.empty())
+        {
+            // rendezvous channel, or a sender parked on a zero-capacity buffer
+            value.emplace(std::move(m_senders.front().value));
+
+            sender = std::move(m_senders.front().onSent);
+
+            m_senders.pop_front();
+        }
+        else if(!m_closed)
+        {
+            m_receivers.push_back(AsyncCallback<std::optional<T>>::make(std::forward<F>(onValue)));
+
+            return;
+        }
+    }
+
+    ThreadPool& pool = *m_pool;
+
+    if(sender != nullptr)
+    {
+        AsyncPrimitives::post(pool, [sender = std::move(sender)]() mutable -> void { sender->invoke(true); });
+    }
+
+    AsyncPrimitives::runOrPost(pool, [onValue = std::decay_t<F>{std::forward<F>(onValue)}, value = std::move(value)]() mutable -> void
+    {
+        onValue(std::move(value));
+    });
+}
+
+template<typename T> bool AsyncChannel<T>::trySend(T& value)
+{
+    std::unique_ptr<AsyncCallback<std::optional<T>>> receiver;
+
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        if(m_closed)
+        {
+            return false;
+        }
+
+        if(m_receivers.empty())
+        {
+            if(m_buffer.size() >= m_capacity)
+            {
+                return false;
+            }
+
+            m_buffer.push_back(std::move(value));
+
+            return true;
+        }
+
+        receiver = std::move(m_receivers.front());
+
+        m_receivers.pop_front();
+    }
+
+    AsyncPrimitives::post(*m_pool, [receiver = std::move(receiver), value = std::move(value)]() mutable -> void
+    {
+        receiver->invoke(std::optional<T>{std::move(value)});
+    });
+
+    return true;
+}
+
+template<typename T> std::optional<T> AsyncChannel<T>::tryReceive()
+{
+    std::optional<T> value;
+
+    std::unique_ptr<AsyncCallback<bool>> sender;
+
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        if(!m_buffer.empty())
+        {
+            value.emplace(std::move(m_buffer.front()));
+
+            m_buffer.pop_front();
+
+            refillFromSender(sender);
+        }
+        else if(!m_senders.empty())
+        {
+            value.emplace(std::move(m_senders.front().value));
+
+            sender = std::move(m_senders.front().onSent);
+
+            m_senders.pop_front();
+        }
+    }
+
+    if(sender != nullptr)
+    {
+        AsyncPrimitives::post(*m_pool, [sender = std::move(sender)]() mutable -> void { sender->invoke(true); });
+    }
+
+    return value;
+}
+
+template<typename T> bool AsyncChannel<T>::refillFromSender(std::unique_ptr<AsyncCallback<bool>>& outSender)
+{
+    if(m_senders.empty() || m_buffer.size() >= m_capacity)
+    {
+        return false;
+    }
+
+    m_buffer.push_back(std::move(m_senders.front().value));
+
+    outSender = std::move(m_senders.front().onSent);
+
+    m_senders.pop_front();
+
+    return true;
+}
+
+template<typename T> void AsyncChannel<T>::close()
+{
+    std::deque<ParkedSender> senders;
+
+    std::deque<std::unique_ptr<AsyncCallback<std::optional<T>>>> receivers;
+
+    {
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        m_closed = true;
+
+        senders.swap(m_senders);
+
+        receivers.swap(m_receivers);
+    }
+
+    ThreadPool& pool = *m_pool;
+
+    for(auto& sender : senders)
+    {
+        AsyncPrimitives::post(pool, [onSent = std::move(sender.onSent)]() mutable -> void { onSent->invoke(false); });
+    }
+
+    for(auto& receiver : receivers)
+    {
+        AsyncPrimitives::post(pool, [receiver = std::move(receiver)]() mutable -> void { receiver->invoke(std::nullopt); });
+    }
+}
+
+template<typename T> bool AsyncChannel<T>::closed()
+{
+    std::lock_guard<std::mutex> lk{m_mut};
+
+    return m_closed;
+}
\ No newline at end of file
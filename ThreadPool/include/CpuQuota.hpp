@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// CPUs the process may actually use: the affinity mask and, inside a container, the CFS quota of its cgroup
+// (v1 or v2), where hardware_concurrency() reports every core of the host. Everything falls back to
+// hardware_concurrency() where the information is not available.
+class CpuQuota
+{
+    public:
+
+        // cumulative CFS throttling counters of the limiting cgroup
+        struct ThrottleStats
+        {
+            uint64_t periods = 0u;
+
+            uint64_t throttledPeriods = 0u;
+
+            uint64_t throttledNs = 0u;
+        };
+
+        // min(affinity, quota), the quota rounded down so a full pool cannot exceed it, at least 1
+        static uint32_t availableCpus();
+
+        static uint32_t affinityCpus();
+
+        // CPUs worth of quota granted by the tightest limit on the way to the root cgroup, std::nullopt if unlimited
+        static std::optional<double> quotaCpus();
+
+        // std::nullopt without a quota, nothing is throttled then
+        static std::optional<ThrottleStats> throttleStats();
+
+    private:
+
+        struct CgroupDirectory
+        {
+            std::string path;
+
+            bool unified;
+        };
+
+        // directories of the cpu controller from the process' cgroup up to the root, for every mounted hierarchy
+        static std::vector<CgroupDirectory> cgroupDirectories();
+
+        static std::optional<double> readQuota(const CgroupDirectory& directory);
+
+        // the directory holding the tightest quota
+        static std::optional<CgroupDirectory> limitingDirectory(double& outQuota);
+
+        static bool readFile(const std::string& path, std::string& outContent);
+};
+
+#include "CpuQuota.inl"
\ No newline at end of file
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+    #include <sched.h>
+#endif
+
+inline uint32_t CpuQuota::availableCpus()
+{
+    uint32_t cpus = affinityCpus();
+
+    if(auto quota = quotaCpus())
+    {
+        cpus = std::min(cpus, static_cast<uint32_t>(std::max(1., std::floor(*quota))));
+    }
+
+    return cpus;
+}
+
+inline uint32_t CpuQuota::affinityCpus()
+{
+#if defined(__linux__)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+
+    if(sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        return std::max(1, CPU_COUNT(&set));
+    }
+#endif
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+inline std::optional<double> CpuQuota::quotaCpus()
+{
+    double quota = 0.;
+
+    if(!limitingDirectory(quota))
+    {
+        return std::nullopt;
+    }
+
+    return quota;
+}
+
+inline std::optional<CpuQuota::ThrottleStats> CpuQuota::throttleStats()
+{
+    double quota = 0.;
+
+    std::optional<CgroupDirectory> directory = limitingDirectory(quota);
+
+    std::string content;
+
+    if(!directory || !readFile(directory->path + "/cpu.stat", content))
+    {
+        return std::nullopt;
+    }
+
+    ThrottleStats stats;
+
+    std::istringstream in{content};
+
+    std::string key;
+
+    uint64_t value = 0u;
+
+    while(in >> key >> value)
+    {
+        if(key == "nr_periods")
+        {
+            stats.periods = value;
+        }
+        else if(key == "nr_throttled")
+        {
+            stats.throttledPeriods = value;
+        }
+        else if(key == "throttled_usec")
+        {
+            stats.throttledNs = value * 1000u;
+        }
+        else if(key == "throttled_time")
+        {
+            stats.throttledNs = value;
+        }
+    }
+
+    return stats;
+}
+
+inline std::vector<CpuQuota::CgroupDirectory> CpuQuota::cgroupDirectories()
+{
+    std::vector<CgroupDirectory> result;
+
+    std::ifstream in{"/proc/self/cgroup"};
+
+    std::string line;
+
+    // hierarchy-id:controllers:path, the unified hierarchy has an empty controller list
+    while(std::getline(in, line))
+    {
+        const size_t first = line.find(':');
+
+        const size_t second = first == std::string::npos ? std::string::npos : line.find(':', first + 1u);
+
+        if(second == std::string::npos)
+        {
+            continue;
+        }
+
+        const std::string controllers = "," + line.substr(first + 1u, second - first - 1u) + ",";
+
+        const bool unified = controllers == ",,";
+
+        if(!unified && controllers.find(",cpu,") == std::string::npos)
+        {
+            continue;
+        }
+
+        // hybrid setups mount the unified hierarchy below the v1 controllers
+        const std::vector<std::string> mounts = unified ? std::vector<std::string>{"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}
+                                                        : std::vector<std::string>{"/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu"};
+
+        for(const std::string& mount : mounts)
+        {
+            // limits on any ancestor apply as well; inside a cgroup namespace the path is just "/"
+            for(std::string path = line.substr(second + 1u); ; path = path.substr(0u, path.rfind('/')))
+            {
+                result.push_back({mount + (path == "/" ? "" : path), unified});
+
+                if(path.empty() || path == "/")
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+inline std::optional<double> CpuQuota::readQuota(const CgroupDirectory& directory)
+{
+    std::string content;
+
+    if(directory.unified)
+    {
+        // "max 100000" or "400000 100000"
+        if(!readFile(directory.path + "/cpu.max", content))
+        {
+            return std::nullopt;
+        }
+
+        std::istringstream in{content};
+
+        std::string quota;
+
+        double period = 0.;
+
+        if(!(in >> quota >> period) || quota == "max" || period <= 0.)
+        {
+            return std::nullopt;
+        }
+
+        return std::atof(quota.c_str()) / period;
+    }
+
+    std::string periodContent;
+
+    if(!readFile(directory.path + "/cpu.cfs_quota_us", content) || !readFile(directory.path + "/cpu.cfs_period_us", periodContent))
+    {
+        return std::nullopt;
+    }
+
+    // -1 is unlimited
+    const double quota = std::atof(content.c_str());
+
+    const double period = std::atof(periodContent.c_str());
+
+    if(quota <= 0. || period <= 0.)
+    {
+        return std::nullopt;
+    }
+
+    return quota / period;
+}
+
+inline std::optional<CpuQuota::CgroupDirectory> CpuQuota::limitingDirectory(double& outQuota)
+{
+    std::optional<CgroupDirectory> result;
+
+    for(const CgroupDirectory& directory : cgroupDirectories())
+    {
+        std::optional<double> quota = readQuota(directory);
+
+        if(quota && (!result || *quota < outQuota))
+        {
+            result = directory;
+
+            outQuota = *quota;
+        }
+    }
+
+    return result;
+}
+
+inline bool CpuQuota::readFile(const std::string& path, std::string& outContent)
+{
+    std::ifstream in{path};
+
+    if(!in)
+    {
+        return false;
+    }
+
+    std::ostringstream content;
+
+    content << in.rdbuf();
+
+    outContent = content.str();
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+// void results are carried as std::monostate inside the combinators
+template<typename T> using FutureValue = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+template<typename T> struct FutureState
+{
+    std::mutex mut;
+
+    std::condition_variable cv;
+
+    bool ready = false;
+
+    std::optional<FutureValue<T>> value;
+
+    std::exception_ptr error;
+
+    // at most one, a Future has a single consumer
+    std::function<void()> continuation;
+};
+
+// Future with a continuation hook. Unlike std::future a consumer can register onReady instead of blocking
+// in get(), which is what whenAll / whenAny build on: completing a future runs its continuation inline on
+// the completing thread, no thread ever waits for the combined result. Move-only, get() consumes it.
+template<typename T> class Future
+{
+    public:
+
+        Future() = default;
+
+        explicit Future(std::shared_ptr<FutureState<T>> state) : m_state{std::move(state)} {}
+
+        bool valid() const;
+
+        bool isReady() const;
+
+        void wait() const;
+
+        // blocks until ready, rethrows a stored exception
+        T get();
+
+        // like get(), void becomes std::monostate
+        FutureValue<T> takeValue();
+
+        // func(Future<T>&&) runs once the future is ready: inline right away if it already is, otherwise on
+        // the thread completing it. Consumes the future.
+        template<typename F> void onReady(F&& func);
+
+    private:
+
+        std::shared_ptr<FutureState<T>> m_state;
+};
+
+// producer side, a promise destroyed without a result fails the future with broken_promise
+template<typename T> class Promise
+{
+    public:
+
+        Promise() : m_state{std::make_shared<FutureState<T>>()} {}
+
+        Promise(Promise&& other) = default;
+
+        Promise& operator=(Promise&& other) = default;
+
+        ~Promise();
+
+        Future<T> getFuture();
+
+        template<typename... Args> void setValue(Args&&... args);
+
+        void setException(std::exception_ptr error);
+
+    private:
+
+        void complete();
+
+        std::shared_ptr<FutureState<T>> m_state;
+};
+
+// shared by the continuations of one whenAll / whenAny call
+template<typename... Ts> struct WhenAllJoin
+{
+    std::atomic<uint32_t> pending{static_cast<uint32_t>(sizeof...(Ts))};
+
+    std::atomic<bool> failed{false};
+
+    std::tuple<std::optional<FutureValue<Ts>>...> values;
+
+    Promise<std::tuple<FutureValue<Ts>...>> promise;
+};
+
+template<typename R> struct WhenAnyJoin
+{
+    std::atomic<bool> done{false};
+
+    Promise<R> promise;
+};
+
+// ready once every future is, fails with the first exception
+template<typename... Ts> Future<std::tuple<FutureValue<Ts>...>> whenAll(Future<Ts>&&... futures);
+
+template<typename T> Future<std::vector<FutureValue<T>>> whenAll(std::vector<Future<T>>&& futures);
+
+// ready with the index and result (or exception) of the first future to complete
+template<typename... Ts> Future<std::pair<size_t, std::variant<FutureValue<Ts>...>>> whenAny(Future<Ts>&&... futures);
+
+template<typename T> Future<std::pair<size_t, FutureValue<T>>> whenAny(std::vector<Future<T>>&& futures);
+
+#include "Future.inl"
\ No newline at end of file
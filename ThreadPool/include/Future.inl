@@ -0,0 +1,345 @@
+#pragma once
+
+template<typename T> bool Future<T>::valid() const
+{
+    return m_state != nullptr;
+}
+
+template<typename T> bool Future<T>::isReady() const
+{
+    std::lock_guard<std::mutex> lk{m_state->mut};
+
+    return m_state->ready;
+}
+
+template<typename T> void Future<T>::wait() const
+{
+    std::unique_lock<std::mutex> lk{m_state->mut};
+
+    m_state->cv.wait(lk, [this]() -> bool { return m_state->ready; });
+}
+
+template<typename T> T Future<T>::get()
+{
+    if constexpr(std::is_void_v<T>)
+    {
+        takeValue();
+    }
+    else
+    {
+        return takeValue();
+    }
+}
+
+template<typename T> FutureValue<T> Future<T>::takeValue()
+{
+    ALWAYS_ASSERT(m_state != nullptr && "<-- assert get on an empty future");
+
+    wait();
+
+    std::shared_ptr<FutureState<T>> state = std::move(m_state);
+
+    if(state->error)
+    {
+        std::rethrow_exception(state->error);
+    }
+
+    return std::move(*state->value);
+}
+
+template<typename T> template<typename F> void Future<T>::onReady(F&& func)
+{
+    ALWAYS_ASSERT(m_state != nullptr && "<-- assert onReady on an empty future");
+
+    std::shared_ptr<FutureState<T>> state = std::move(m_state);
+
+    {
+        std::lock_guard<std::mutex> lk{state->mut};
+
+        if(!state->ready)
+        {
+            state->continuation = [state, func = std::forward<F>(func)]() mutable -> void { func(Future<T>{state}); };
+
+            return;
+        }
+    }
+
+    func(Future<T>{std::move(state)});
+}
+
+template<typename T> Promise<T>::~Promise()
+{
+    if(m_state == nullptr)
+    {
+        return;
+    }
+
+    bool ready = false;
+
+    {
+        std::lock_guard<std::mutex> lk{m_state->mut};
+
+        ready = m_state->ready;
+    }
+
+    if(!ready)
+    {
+        setException(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+    }
+}
+
+template<typename T> Future<T> Promise<T>::getFuture()
+{
+    return Future<T>{m_state};
+}
+
+template<typename T> template<typename... Args> void Promise<T>::setValue(Args&&... args)
+{
+    {
+        std::lock_guard<std::mutex> lk{m_state->mut};
+
+        m_state->value.emplace(std::forward<Args>(args)...);
+
+        m_state->ready = true;
+    }
+
+    complete();
+}
+
+template<typename T> void Promise<T>::setException(std::exception_ptr error)
+{
+    {
+        std::lock_guard<std::mutex> lk{m_state->mut};
+
+        m_state->error = std::move(error);
+
+        m_state->ready = true;
+    }
+
+    complete();
+}
+
+template<typename T> void Promise<T>::complete()
+{
+    std::function<void()> continuation;
+
+    {
+        std::lock_guard<std::mutex> lk{m_state->mut};
+
+        continuation = std::move(m_state->continuation);
+
+        m_state->continuation = nullptr;
+
+        m_state->cv.notify_all();
+    }
+
+    // outside the lock, the continuation may complete further promises
+    if(continuation)
+    {
+        continuation();
+    }
+}
+
+template<typename F> ThreadPool::FutureResult<F> ThreadPool::executeFuture(F&& func)
+{
+    typedef typename std::result_of<F()>::type ResultType;
+
+    Promise<ResultType> promise;
+
+    Future<ResultType> result = promise.getFuture();
+
+    executeAsync(std::make_unique<FunctionWrapper>([promise = std::move(promise), func = std::move(func)]() mutable -> void
+    {
+        try
+        {
+            if constexpr(std::is_void_v<ResultType>)
+            {
+                func();
+
+                promise.setValue();
+            }
+            else
+            {
+                promise.setValue(func());
+            }
+        }
+        catch(...)
+        {
+            promise.setException(std::current_exception());
+        }
+    }));
+
+    return result;
+}
+
+template<typename... Ts, size_t... Is> void whenAllAttach(const std::shared_ptr<WhenAllJoin<Ts...>>& join, std::tuple<Future<Ts>...>& futures, std::index_sequence<Is...>)
+{
+    (std::get<Is>(futures).onReady([join](Future<Ts>&& future) -> void
+    {
+        try
+        {
+            std::get<Is>(join->values).emplace(future.takeValue());
+        }
+        catch(...)
+        {
+            if(!join->failed.exchange(true))
+            {
+                join->promise.setException(std::current_exception());
+            }
+        }
+
+        // the last continuation to finish completes the promise, unless one of them failed it already
+        if(join->pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u && !join->failed.load())
+        {
+            join->promise.setValue(std::apply([](auto&... values) -> std::tuple<FutureValue<Ts>...> { return {std::move(*values)...}; }, join->values));
+        }
+    }), ...);
+}
+
+template<typename... Ts> Future<std::tuple<FutureValue<Ts>...>> whenAll(Future<Ts>&&... futures)
+{
+    auto join = std::make_shared<WhenAllJoin<Ts...>>();
+
+    Future<std::tuple<FutureValue<Ts>...>> result = join->promise.getFuture();
+
+    if constexpr(sizeof...(Ts) == 0u)
+    {
+        join->promise.setValue();
+    }
+    else
+    {
+        std::tuple<Future<Ts>...> owned{std::move(futures)...};
+
+        whenAllAttach(join, owned, std::index_sequence_for<Ts...>{});
+    }
+
+    return result;
+}
+
+template<typename T> Future<std::vector<FutureValue<T>>> whenAll(std::vector<Future<T>>&& futures)
+{
+    struct Join
+    {
+        std::atomic<uint32_t> pending;
+
+        std::atomic<bool> failed{false};
+
+        std::vector<std::optional<FutureValue<T>>> values;
+
+        Promise<std::vector<FutureValue<T>>> promise;
+    };
+
+    auto join = std::make_shared<Join>();
+
+    join->pending = static_cast<uint32_t>(futures.size());
+
+    join->values.resize(futures.size());
+
+    Future<std::vector<FutureValue<T>>> result = join->promise.getFuture();
+
+    if(futures.empty())
+    {
+        join->promise.setValue();
+    }
+
+    for(size_t i = 0u; i < futures.size(); ++i)
+    {
+        futures[i].onReady([join, i](Future<T>&& future) -> void
+        {
+            try
+            {
+                join->values[i].emplace(future.takeValue());
+            }
+            catch(...)
+            {
+                if(!join->failed.exchange(true))
+                {
+                    join->promise.setException(std::current_exception());
+                }
+            }
+
+            if(join->pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u && !join->failed.load())
+            {
+                std::vector<FutureValue<T>> values;
+                values.reserve(join->values.size());
+
+                for(auto& value : join->values)
+                {
+                    values.push_back(std::move(*value));
+                }
+
+                join->promise.setValue(std::move(values));
+            }
+        });
+    }
+
+    return result;
+}
+
+template<typename... Ts, size_t... Is> void whenAnyAttach(const std::shared_ptr<WhenAnyJoin<std::pair<size_t, std::variant<FutureValue<Ts>...>>>>& join,
+                                                          std::tuple<Future<Ts>...>& futures, std::index_sequence<Is...>)
+{
+    (std::get<Is>(futures).onReady([join](Future<Ts>&& future) -> void
+    {
+        // the first one to complete wins, the rest only drop their result
+        if(join->done.exchange(true))
+        {
+            return;
+        }
+
+        try
+        {
+            join->promise.setValue(Is, std::variant<FutureValue<Ts>...>{std::in_place_index<Is>, future.takeValue()});
+        }
+        catch(...)
+        {
+            join->promise.setException(std::current_exception());
+        }
+    }), ...);
+}
+
+template<typename... Ts> Future<std::pair<size_t, std::variant<FutureValue<Ts>...>>> whenAny(Future<Ts>&&... futures)
+{
+    static_assert(sizeof...(Ts) != 0u, "whenAny needs at least one future");
+
+    auto join = std::make_shared<WhenAnyJoin<std::pair<size_t, std::variant<FutureValue<Ts>...>>>>();
+
+    Future<std::pair<size_t, std::variant<FutureValue<Ts>...>>> result = join->promise.getFuture();
+
+    std::tuple<Future<Ts>...> owned{std::move(futures)...};
+
+    whenAnyAttach(join, owned, std::index_sequence_for<Ts...>{});
+
+    return result;
+}
+
+template<typename T> Future<std::pair<size_t, FutureValue<T>>> whenAny(std::vector<Future<T>>&& futures)
+{
+    ALWAYS_ASSERT(!futures.empty() && "<-- assert whenAny on no futures");
+
+    auto join = std::make_shared<WhenAnyJoin<std::pair<size_t, FutureValue<T>>>>();
+
+    Future<std::pair<size_t, FutureValue<T>>> result = join->promise.getFuture();
+
+    for(size_t i = 0u; i < futures.size(); ++i)
+    {
+        futures[i].onReady([join, i](Future<T>&& future) -> void
+        {
+            if(join->done.exchange(true))
+            {
+                return;
+            }
+
+            try
+            {
+                join->promise.setValue(i, future.takeValue());
+            }
+            catch(...)
+            {
+                join->promise.setException(std::current_exception());
+            }
+        });
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Per-task-class latency histograms. Compiled in only when THREADPOOL_HISTOGRAMS is defined to a non-zero value.
+#ifndef THREADPOOL_HISTOGRAMS
+    #define THREADPOOL_HISTOGRAMS 0
+#endif
+
+#ifndef THREADPOOL_MAX_TASK_CLASSES
+    #define THREADPOOL_MAX_TASK_CLASSES 8
+#endif
+
+// HDR-style log-bucketed histogram of nanosecond values: exact below 16ns, 16 linear sub-buckets
+// per power of two above that, so every recorded value is off by at most 1/16 of its magnitude.
+// Single writer, any number of concurrent readers.
+class LatencyHistogram
+{
+    public:
+
+        static constexpr uint32_t SUB_BUCKET_BITS = 4u;
+
+        static constexpr uint32_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+
+        static constexpr uint32_t BUCKET_COUNT = (64u - SUB_BUCKET_BITS + 1u) * SUB_BUCKET_COUNT;
+
+        LatencyHistogram() = default;
+
+        LatencyHistogram(const LatencyHistogram& other);
+
+        LatencyHistogram& operator=(const LatencyHistogram& other);
+
+        void record(uint64_t value);
+
+        void merge(const LatencyHistogram& other);
+
+        void reset();
+
+        uint64_t count() const;
+
+        uint64_t max() const;
+
+        // percentile in [0, 100], returns the midpoint of the bucket holding it
+        uint64_t percentile(double percent) const;
+
+        static uint32_t bucketIndex(uint64_t value);
+
+        static uint64_t bucketValue(uint32_t index);
+
+    private:
+
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+
+        std::atomic<uint64_t> m_count{0u};
+
+        std::atomic<uint64_t> m_max{0u};
+};
+
+// one per worker, indexed by ThreadPool::TaskInfo::taskClass
+struct TaskLatencyRecorder
+{
+    std::array<LatencyHistogram, THREADPOOL_MAX_TASK_CLASSES> queueWait;
+
+    std::array<LatencyHistogram, THREADPOOL_MAX_TASK_CLASSES> execution;
+};
+
+#include "LatencyHistogram.inl"
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+inline LatencyHistogram::LatencyHistogram(const LatencyHistogram& other)
+{
+    merge(other);
+}
+
+inline LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other)
+{
+    if(this != &other)
+    {
+        reset();
+
+        merge(other);
+    }
+
+    return *this;
+}
+
+inline uint32_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if(value < SUB_BUCKET_COUNT)
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+#ifdef _MSC_VER
+    unsigned long msb = 0u;
+
+    _BitScanReverse64(&msb, value);
+#else
+    uint32_t msb = 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+
+    uint32_t shift = static_cast<uint32_t>(msb) - SUB_BUCKET_BITS;
+
+    uint32_t subBucket = static_cast<uint32_t>(value >> shift) & (SUB_BUCKET_COUNT - 1u);
+
+    return (shift + 1u) * SUB_BUCKET_COUNT + subBucket;
+}
+
+inline uint64_t LatencyHistogram::bucketValue(uint32_t index)
+{
+    if(index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+
+    uint32_t shift = index / SUB_BUCKET_COUNT - 1u;
+
+    uint64_t lowerBound = static_cast<uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+
+    return lowerBound + ((uint64_t{1u} << shift) >> 1u);
+}
+
+inline void LatencyHistogram::record(uint64_t value)
+{
+    // single writer, so plain load/store pairs are enough and avoid locked instructions
+    auto& bucket = m_buckets[bucketIndex(value)];
+
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+
+    m_count.store(m_count.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+
+    if(value > m_max.load(std::memory_order_relaxed))
+    {
+        m_max.store(value, std::memory_order_relaxed);
+    }
+}
+
+inline void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    uint64_t total = 0u;
+
+    for(uint32_t i = 0u; i < BUCKET_COUNT; ++i)
+    {
+        uint64_t bucketCount = other.m_buckets[i].load(std::memory_order_relaxed);
+
+        m_buckets[i].fetch_add(bucketCount, std::memory_order_relaxed);
+
+        total += bucketCount;
+    }
+
+    // recount from the buckets so a concurrently written source still yields a consistent snapshot
+    m_count.fetch_add(total, std::memory_order_relaxed);
+
+    m_max.store(std::max(m_max.load(std::memory_order_relaxed), other.m_max.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+}
+
+inline void LatencyHistogram::reset()
+{
+    for(auto& bucket : m_buckets)
+    {
+        bucket.store(0u, std::memory_order_relaxed);
+    }
+
+    m_count.store(0u, std::memory_order_relaxed);
+
+    m_max.store(0u, std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::max() const
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::percentile(double percent) const
+{
+    uint64_t total = count();
+
+    if(total == 0u)
+    {
+        return 0u;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(percent, 0., 100.) / 100. * static_cast<double>(total)));
+
+    rank = std::max<uint64_t>(rank, 1u);
+
+    uint64_t seen = 0u;
+
+    for(uint32_t i = 0u; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+
+        if(seen >= rank)
+        {
+            return std::min(bucketValue(i), max());
+        }
+    }
+
+    return max();
+}
\ No newline at end of file
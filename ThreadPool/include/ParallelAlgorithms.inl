@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+inline uint32_t ThreadPool::bulkBlockCount(size_t n, size_t cutoff) const
+{
+    // a single worker gains nothing from splitting, a worker waiting on its own pool could deadlock
+    if(m_workers.size() < 2u || isWorkerThread())
+    {
+        return 1u;
+    }
+
+    const size_t blocks = std::min<size_t>(m_workers.size() * BULK_TASKS_PER_WORKER, n / cutoff);
+
+    return static_cast<uint32_t>(std::max<size_t>(blocks, 1u));
+}
+
+template<typename F> void ThreadPool::parallelFor(uint32_t count, F&& body)
+{
+    if(count < 2u || isWorkerThread())
+    {
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            body(i);
+        }
+
+        return;
+    }
+
+    std::vector<FunctionWrapper::Ptr> tasks;
+    tasks.reserve(count);
+
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        tasks.push_back(std::make_unique<FunctionWrapper>([&body, i]() -> void { body(i); }));
+    }
+
+    addTasksWithBarrier(std::move(tasks), []() -> void {}).get();
+}
+
+template<typename RandomIt, typename Compare> void ThreadPool::parallelSort(RandomIt first, RandomIt last, Compare comp)
+{
+    using ValueType = typename std::iterator_traits<RandomIt>::value_type;
+
+    const size_t n = static_cast<size_t>(last - first);
+
+    const uint32_t blocks = bulkBlockCount(n, SORT_SEQUENTIAL_CUTOFF);
+
+    if(blocks < 2u)
+    {
+        std::sort(first, last, comp);
+
+        return;
+    }
+
+    // the input is split into as many blocks as there are buckets
+    const uint32_t buckets = blocks;
+
+    const size_t oversampling = 32u;
+
+    std::vector<ValueType> sample;
+    sample.reserve(buckets * oversampling);
+
+    for(size_t i = 0u; i < buckets * oversampling; ++i)
+    {
+        sample.push_back(first[static_cast<std::ptrdiff_t>(i * n / (buckets * oversampling))]);
+    }
+
+    std::sort(sample.begin(), sample.end(), comp);
+
+    std::vector<ValueType> splitters;
+    splitters.reserve(buckets - 1u);
+
+    for(uint32_t k = 1u; k < buckets; ++k)
+    {
+        splitters.push_back(sample[k * oversampling]);
+    }
+
+    auto bucketOf = [&splitters, &comp](const ValueType& value) -> size_t
+    {
+        return static_cast<size_t>(std::upper_bound(splitters.begin(), splitters.end(), value, comp) - splitters.begin());
+    };
+
+    auto blockBegin = [n, blocks](uint32_t block) -> size_t
+    {
+        return n * block / blocks;
+    };
+
+    // counts[block * buckets + bucket], turned into scatter offsets below
+    std::vector<size_t> counts(static_cast<size_t>(blocks) * buckets, 0u);
+
+    parallelFor(blocks, [&](uint32_t block) -> void
+    {
+        size_t* blockCounts = &counts[static_cast<size_t>(block) * buckets];
+
+        for(size_t i = blockBegin(block); i < blockBegin(block + 1u); ++i)
+        {
+            ++blockCounts[bucketOf(first[static_cast<std::ptrdiff_t>(i)])];
+        }
+    });
+
+    std::vector<size_t> bucketBegin(buckets + 1u, 0u);
+
+    size_t offset = 0u;
+
+    for(uint32_t bucket = 0u; bucket < buckets; ++bucket)
+    {
+        bucketBegin[bucket] = offset;
+
+        for(uint32_t block = 0u; block < blocks; ++block)
+        {
+            const size_t count = counts[static_cast<size_t>(block) * buckets + bucket];
+
+            counts[static_cast<size_t>(block) * buckets + bucket] = offset;
+
+            offset += count;
+        }
+    }
+
+    bucketBegin[buckets] = n;
+
+    std::vector<ValueType> buffer(n);
+
+    parallelFor(blocks, [&](uint32_t block) -> void
+    {
+        size_t* blockOffsets = &counts[static_cast<size_t>(block) * buckets];
+
+        for(size_t i = blockBegin(block); i < blockBegin(block + 1u); ++i)
+        {
+            auto& value = first[static_cast<std::ptrdiff_t>(i)];
+
+            buffer[blockOffsets[bucketOf(value)]++] = std::move(value);
+        }
+    });
+
+    // buckets are disjoint and ordered, each one is sorted and moved back on its own
+    parallelFor(buckets, [&](uint32_t bucket) -> void
+    {
+        auto bucketFirst = buffer.begin() + static_cast<std::ptrdiff_t>(bucketBegin[bucket]);
+
+        auto bucketLast = buffer.begin() + static_cast<std::ptrdiff_t>(bucketBegin[bucket + 1u]);
+
+        std::sort(bucketFirst, bucketLast, comp);
+
+        std::move(bucketFirst, bucketLast, first + static_cast<std::ptrdiff_t>(bucketBegin[bucket]));
+    });
+}
+
+template<typename RandomIt, typename RandomOutputIt, typename BinaryOp> RandomOutputIt ThreadPool::parallelInclusiveScan(RandomIt first, RandomIt last, RandomOutputIt dFirst, BinaryOp op)
+{
+    using ValueType = typename std::iterator_traits<RandomIt>::value_type;
+
+    const size_t n = static_cast<size_t>(last - first);
+
+    const uint32_t blocks = bulkBlockCount(n, SCAN_SEQUENTIAL_CUTOFF);
+
+    if(blocks < 2u)
+    {
+        return std::inclusive_scan(first, last, dFirst, op);
+    }
+
+    auto blockBegin = [n, blocks](uint32_t block) -> std::ptrdiff_t
+    {
+        return static_cast<std::ptrdiff_t>(n * block / blocks);
+    };
+
+    std::vector<ValueType> totals(blocks);
+
+    // the last block's total is never needed
+    parallelFor(blocks - 1u, [&](uint32_t block) -> void
+    {
+        RandomIt it = first + blockBegin(block);
+
+        ValueType total = *it;
+
+        for(++it; it != first + blockBegin(block + 1u); ++it)
+        {
+            total = op(std::move(total), *it);
+        }
+
+        totals[block] = std::move(total);
+    });
+
+    // carries[block] is the scan of everything before the block, carries[0] is unused
+    std::vector<ValueType> carries(blocks);
+
+    carries[1] = totals[0];
+
+    for(uint32_t block = 2u; block < blocks; ++block)
+    {
+        carries[block] = op(carries[block - 1u], totals[block - 1u]);
+    }
+
+    parallelFor(blocks, [&](uint32_t block) -> void
+    {
+        if(block == 0u)
+        {
+            std::inclusive_scan(first, first + blockBegin(1u), dFirst, op);
+        }
+        else
+        {
+            std::inclusive_scan(first + blockBegin(block), first + blockBegin(block + 1u), dFirst + blockBegin(block), op, carries[block]);
+        }
+    });
+
+    return dFirst + static_cast<std::ptrdiff_t>(n);
+}
+
+template<typename RandomIt, typename RandomOutputIt, typename T, typename BinaryOp> RandomOutputIt ThreadPool::parallelExclusiveScan(RandomIt first, RandomIt last, RandomOutputIt dFirst, T init, BinaryOp op)
+{
+    const size_t n = static_cast<size_t>(last - first);
+
+    const uint32_t blocks = bulkBlockCount(n, SCAN_SEQUENTIAL_CUTOFF);
+
+    if(blocks < 2u)
+    {
+        return std::exclusive_scan(first, last, dFirst, std::move(init), op);
+    }
+
+    auto blockBegin = [n, blocks](uint32_t block) -> std::ptrdiff_t
+    {
+        return static_cast<std::ptrdiff_t>(n * block / blocks);
+    };
+
+    std::vector<T> totals(blocks);
+
+    parallelFor(blocks - 1u, [&](uint32_t block) -> void
+    {
+        RandomIt it = first + blockBegin(block);
+
+        T total = *it;
+
+        for(++it; it != first + blockBegin(block + 1u); ++it)
+        {
+            total = op(std::move(total), *it);
+        }
+
+        totals[block] = std::move(total);
+    });
+
+    std::vector<T> carries(blocks);
+
+    carries[0] = std::move(init);
+
+    for(uint32_t block = 1u; block < blocks; ++block)
+    {
+        carries[block] = op(carries[block - 1u], totals[block - 1u]);
+    }
+
+    parallelFor(blocks, [&](uint32_t block) -> void
+    {
+        std::exclusive_scan(first + blockBegin(block), first + blockBegin(block + 1u), dFirst + blockBegin(block), carries[block], op);
+    });
+
+    return dFirst + static_cast<std::ptrdiff_t>(n);
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+enum class MapOrder
+{
+    // completion order
+    UNORDERED,
+    // input order
+    ORDERED
+};
+
+// Maps func over [first, last) on a ThreadPool and hands the results to one consumer through next().
+// UNORDERED delivers results the moment their task finishes, ORDERED delivers them in input order through a
+// reorder buffer. Either way at most window inputs are submitted but not yet consumed, the next input is only
+// submitted once the consumer takes a result, which bounds memory and keeps a slow consumer from being buried.
+// An exception thrown by func is rethrown from the next() call delivering that input.
+// The consumer must not be a pool task, next() blocks.
+template<typename R> class ParallelMap
+{
+    public:
+
+        static constexpr uint32_t DEFAULT_WINDOW = 256u;
+
+        template<typename InputIt, typename F> ParallelMap(ThreadPool& pool, InputIt first, InputIt last, F&& func, MapOrder order = MapOrder::UNORDERED, uint32_t window = DEFAULT_WINDOW);
+
+        ParallelMap(const ParallelMap& other) = delete;
+
+        ParallelMap& operator=(const ParallelMap& other) = delete;
+
+        // waits for the submitted tasks, results not consumed yet are dropped
+        ~ParallelMap();
+
+        // blocks until the next result is ready, false once every input was delivered
+        bool next(R& outResult);
+
+        // outIndex is the position of the input the result belongs to
+        bool next(size_t& outIndex, R& outResult);
+
+        size_t size() const;
+
+    private:
+
+        struct Completion
+        {
+            size_t index = 0u;
+
+            std::optional<R> value;
+
+            std::exception_ptr error;
+        };
+
+        void complete(Completion&& completion);
+
+        MapOrder m_order;
+
+        size_t m_size;
+
+        size_t m_consumed = 0u;
+
+        // submits the task for the next input, false once the inputs are exhausted
+        std::function<bool()> m_submitNext;
+
+        std::mutex m_mut;
+
+        std::condition_variable m_cv;
+
+        uint32_t m_inFlight = 0u;
+
+        // ORDERED: ring indexed by input index % window
+        std::vector<std::optional<Completion>> m_reorderBuffer;
+
+        // UNORDERED: finished, not yet consumed
+        std::deque<Completion> m_completed;
+};
+
+template<typename InputIt, typename F, typename... Rest> ParallelMap(ThreadPool&, InputIt, InputIt, F&&, Rest...)
+    -> ParallelMap<std::invoke_result_t<std::decay_t<F>&, typename std::iterator_traits<InputIt>::reference>>;
+
+#include "ParallelMap.inl"
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+template<typename R> template<typename InputIt, typename F> ParallelMap<R>::ParallelMap(ThreadPool& pool, InputIt first, InputIt last, F&& func, MapOrder order, uint32_t window)
+    : m_order{order}, m_size{static_cast<size_t>(std::distance(first, last))}
+{
+    DEBUG_ASSERT(window != 0u);
+
+    if(m_order == MapOrder::ORDERED)
+    {
+        m_reorderBuffer.resize(window);
+    }
+
+    // the closure owns func and the input cursor, tasks call func through a pointer into it
+    m_submitNext = [this, &pool, first, last, index = size_t{0u}, func = std::forward<F>(func)]() mutable -> bool
+    {
+        if(first == last)
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lk{m_mut};
+
+            ++m_inFlight;
+        }
+
+        pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([this, funcPtr = &func, index, input = typename std::iterator_traits<InputIt>::value_type(*first)]() mutable -> void
+        {
+            Completion completion;
+
+            completion.index = index;
+
+            try
+            {
+                completion.value.emplace((*funcPtr)(input));
+            }
+            catch(...)
+            {
+                completion.error = std::current_exception();
+            }
+
+            complete(std::move(completion));
+        }));
+
+        ++first;
+
+        ++index;
+
+        return true;
+    };
+
+    for(uint32_t i = 0u; i < window && m_submitNext(); ++i)
+    {
+    }
+}
+
+template<typename R> ParallelMap<R>::~ParallelMap()
+{
+    std::unique_lock<std::mutex> lk{m_mut};
+
+    m_cv.wait(lk, [this]() -> bool { return m_inFlight == 0u; });
+}
+
+template<typename R> void ParallelMap<R>::complete(Completion&& completion)
+{
+    std::lock_guard<std::mutex> lk{m_mut};
+
+    if(m_order == MapOrder::ORDERED)
+    {
+        // the window keeps unconsumed indices within one lap of the ring
+        m_reorderBuffer[completion.index % m_reorderBuffer.size()] = std::move(completion);
+    }
+    else
+    {
+        m_completed.push_back(std::move(completion));
+    }
+
+    --m_inFlight;
+
+    // the consumer and, on early destruction, the destructor wait on the same condition variable
+    m_cv.notify_all();
+}
+
+template<typename R> bool ParallelMap<R>::next(R& outResult)
+{
+    size_t index = 0u;
+
+    return next(index, outResult);
+}
+
+template<typename R> bool ParallelMap<R>::next(size_t& outIndex, R& outResult)
+{
+    if(m_consumed == m_size)
+    {
+        return false;
+    }
+
+    Completion completion;
+
+    {
+        std::unique_lock<std::mutex> lk{m_mut};
+
+        if(m_order == MapOrder::ORDERED)
+        {
+            std::optional<Completion>& slot = m_reorderBuffer[m_consumed % m_reorderBuffer.size()];
+
+            m_cv.wait(lk, [&slot]() -> bool { return slot.has_value(); });
+
+            completion = std::move(*slot);
+
+            slot.reset();
+        }
+        else
+        {
+            m_cv.wait(lk, [this]() -> bool { return !m_completed.empty(); });
+
+            completion = std::move(m_completed.front());
+
+            m_completed.pop_front();
+        }
+    }
+
+    ++m_consumed;
+
+    // a slot of the window just freed up
+    m_submitNext();
+
+    outIndex = completion.index;
+
+    if(completion.error)
+    {
+        std::rethrow_exception(completion.error);
+    }
+
+    outResult = std::move(*completion.value);
+
+    return true;
+}
+
+template<typename R> size_t ParallelMap<R>::size() const
+{
+    return m_size;
+}
\ No newline at end of file
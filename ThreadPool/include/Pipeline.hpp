@@ -0,0 +1,124 @@
+#pragma once
+
+#include <any>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+// Streaming pipeline over a ThreadPool: a serial source followed by serial-in-order, serial-out-of-order or
+// parallel stages. A fixed number of tokens bounds the items in flight. A token carries its item through as
+// many stages as it can on one worker; a token that finds a serial stage occupied (or, for in-order stages,
+// not yet at its turn) is parked there and picked up by the worker leaving the stage, so no worker ever
+// blocks on a stage. Items are held in std::any, so their types must be copy constructible.
+// Stage functions must not throw.
+class Pipeline
+{
+    public:
+
+        enum class StageMode
+        {
+            // one item at a time, in source order
+            SERIAL_IN_ORDER,
+            // one item at a time, in any order
+            SERIAL_OUT_OF_ORDER,
+            // any number of items at once
+            PARALLEL
+        };
+
+        explicit Pipeline(ThreadPool& pool);
+
+        Pipeline(const Pipeline& other) = delete;
+
+        Pipeline& operator=(const Pipeline& other) = delete;
+
+        // func: () -> std::optional<T>, an empty optional ends the stream. Always serial and in order.
+        template<typename T, typename F> Pipeline& source(F&& func);
+
+        // func: (In) -> Out
+        template<typename In, typename Out, typename F> Pipeline& stage(StageMode mode, F&& func);
+
+        // func: (In) -> void, ends the pipeline
+        template<typename In, typename F> Pipeline& sink(StageMode mode, F&& func);
+
+        // streams the source through the stages with at most maxTokens items in flight and returns once the
+        // last item left the pipeline. Must not be called from inside a pool task.
+        void run(uint32_t maxTokens);
+
+    private:
+
+        struct Token
+        {
+            std::any item;
+
+            uint64_t sequence = 0u;
+        };
+
+        struct Stage
+        {
+            StageMode mode;
+
+            std::function<void(std::any&)> func;
+
+            std::mutex mut;
+
+            bool busy = false;
+
+            // next sequence number an in-order stage accepts
+            uint64_t nextSequence = 0u;
+
+            // parked tokens: indexed by sequence % maxTokens for in-order stages, a plain stack otherwise
+            std::vector<Token*> parked;
+
+            Stage(StageMode stageMode, std::function<void(std::any&)>&& stageFunc) : mode{stageMode}, func{std::move(stageFunc)} {}
+        };
+
+        // carries token through the stages starting at stageIndex, then back to the source until it runs dry.
+        // entered: the serial stage at stageIndex was already claimed on the token's behalf
+        void runToken(Token* token, size_t stageIndex, bool entered);
+
+        // claims a serial stage for token or parks it there
+        bool tryEnter(Stage& stage, Token* token);
+
+        // releases a serial stage and resumes the parked token that may run next, if any
+        void leave(Stage& stage, size_t stageIndex);
+
+        // source side of tryEnter / leave, a source stage holds tokens without items
+        bool tryEnterSource(Token* token);
+
+        void leaveSource(bool exhausted);
+
+        void retire(uint32_t count);
+
+        void spawn(Token* token, size_t stageIndex, bool entered);
+
+        ThreadPool* m_pool;
+
+        std::function<bool(std::any&)> m_source;
+
+        std::mutex m_sourceMut;
+
+        bool m_sourceBusy = false;
+
+        bool m_sourceExhausted = false;
+
+        uint64_t m_nextSequence = 0u;
+
+        std::vector<Token*> m_idleTokens;
+
+        // std::mutex is not movable, stages live on the heap
+        std::vector<std::unique_ptr<Stage>> m_stages;
+
+        std::vector<Token> m_tokens;
+
+        std::atomic<uint32_t> m_liveTokens{0u};
+
+        std::promise<void> m_done;
+};
+
+#include "Pipeline.inl"
\ No newline at end of file
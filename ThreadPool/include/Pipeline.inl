@@ -0,0 +1,299 @@
+#pragma once
+
+inline Pipeline::Pipeline(ThreadPool& pool) : m_pool{&pool}
+{
+}
+
+template<typename T, typename F> Pipeline& Pipeline::source(F&& func)
+{
+    m_source = [func = std::forward<F>(func)](std::any& outItem) mutable -> bool
+    {
+        std::optional<T> item = func();
+
+        if(!item)
+        {
+            return false;
+        }
+
+        outItem = std::move(*item);
+
+        return true;
+    };
+
+    return *this;
+}
+
+template<typename In, typename Out, typename F> Pipeline& Pipeline::stage(StageMode mode, F&& func)
+{
+    m_stages.push_back(std::make_unique<Stage>(mode, [func = std::forward<F>(func)](std::any& inoutItem) mutable -> void
+    {
+        inoutItem = Out(func(std::move(*std::any_cast<In>(&inoutItem))));
+    }));
+
+    return *this;
+}
+
+template<typename In, typename F> Pipeline& Pipeline::sink(StageMode mode, F&& func)
+{
+    m_stages.push_back(std::make_unique<Stage>(mode, [func = std::forward<F>(func)](std::any& inoutItem) mutable -> void
+    {
+        func(std::move(*std::any_cast<In>(&inoutItem)));
+
+        inoutItem.reset();
+    }));
+
+    return *this;
+}
+
+inline void Pipeline::run(uint32_t maxTokens)
+{
+    ALWAYS_ASSERT(m_source && "<-- assert missed source call");
+
+    DEBUG_ASSERT(maxTokens != 0u && !ThreadPool::isWorkerThread());
+
+    m_tokens = std::vector<Token>(maxTokens);
+
+    for(auto& stage : m_stages)
+    {
+        stage->busy = false;
+
+        stage->nextSequence = 0u;
+
+        stage->parked.clear();
+
+        if(stage->mode == StageMode::SERIAL_IN_ORDER)
+        {
+            stage->parked.resize(maxTokens, nullptr);
+        }
+        else
+        {
+            stage->parked.reserve(maxTokens);
+        }
+    }
+
+    m_sourceBusy = false;
+
+    m_sourceExhausted = false;
+
+    m_nextSequence = 0u;
+
+    m_idleTokens.clear();
+
+    m_idleTokens.reserve(maxTokens);
+
+    m_liveTokens = maxTokens;
+
+    m_done = std::promise<void>{};
+
+    std::future<void> done = m_done.get_future();
+
+    for(auto& token : m_tokens)
+    {
+        spawn(&token, 0u, false);
+    }
+
+    done.get();
+}
+
+inline void Pipeline::spawn(Token* token, size_t stageIndex, bool entered)
+{
+    m_pool->executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([this, token, stageIndex, entered]() -> void
+    {
+        runToken(token, stageIndex, entered);
+    }));
+}
+
+inline void Pipeline::runToken(Token* token, size_t stageIndex, bool entered)
+{
+    while(true)
+    {
+        // stage 0 is the source, m_stages[i - 1] is stage i
+        if(stageIndex == 0u)
+        {
+            if(!entered && !tryEnterSource(token))
+            {
+                return;
+            }
+
+            const bool produced = m_source(token->item);
+
+            token->sequence = m_nextSequence;
+
+            m_nextSequence += produced ? 1u : 0u;
+
+            leaveSource(!produced);
+
+            if(!produced)
+            {
+                retire(1u);
+
+                return;
+            }
+
+            entered = false;
+
+            stageIndex = 1u;
+        }
+
+        for(; stageIndex <= m_stages.size(); ++stageIndex)
+        {
+            Stage& stage = *m_stages[stageIndex - 1u];
+
+            if(stage.mode == StageMode::PARALLEL)
+            {
+                stage.func(token->item);
+
+                continue;
+            }
+
+            if(!entered && !tryEnter(stage, token))
+            {
+                return;
+            }
+
+            entered = false;
+
+            stage.func(token->item);
+
+            leave(stage, stageIndex);
+        }
+
+        // the item left the pipeline, the token goes back for the next one
+        token->item.reset();
+
+        stageIndex = 0u;
+    }
+}
+
+inline bool Pipeline::tryEnter(Stage& stage, Token* token)
+{
+    std::lock_guard<std::mutex> lk{stage.mut};
+
+    if(!stage.busy && (stage.mode == StageMode::SERIAL_OUT_OF_ORDER || token->sequence == stage.nextSequence))
+    {
+        stage.busy = true;
+
+        return true;
+    }
+
+    // at most m_tokens.size() items are in flight, so the parked sequence numbers never collide
+    if(stage.mode == StageMode::SERIAL_IN_ORDER)
+    {
+        stage.parked[token->sequence % stage.parked.size()] = token;
+    }
+    else
+    {
+        stage.parked.push_back(token);
+    }
+
+    return false;
+}
+
+inline void Pipeline::leave(Stage& stage, size_t stageIndex)
+{
+    Token* next = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lk{stage.mut};
+
+        if(stage.mode == StageMode::SERIAL_IN_ORDER)
+        {
+            ++stage.nextSequence;
+
+            Token*& slot = stage.parked[stage.nextSequence % stage.parked.size()];
+
+            if(slot != nullptr && slot->sequence == stage.nextSequence)
+            {
+                next = slot;
+
+                slot = nullptr;
+            }
+        }
+        else if(!stage.parked.empty())
+        {
+            next = stage.parked.back();
+
+            stage.parked.pop_back();
+        }
+
+        // handed over still claimed, nobody can overtake the parked token
+        stage.busy = next != nullptr;
+    }
+
+    if(next != nullptr)
+    {
+        spawn(next, stageIndex, true);
+    }
+}
+
+inline bool Pipeline::tryEnterSource(Token* token)
+{
+    {
+        std::lock_guard<std::mutex> lk{m_sourceMut};
+
+        if(!m_sourceExhausted)
+        {
+            if(m_sourceBusy)
+            {
+                m_idleTokens.push_back(token);
+
+                return false;
+            }
+
+            m_sourceBusy = true;
+
+            return true;
+        }
+    }
+
+    retire(1u);
+
+    return false;
+}
+
+inline void Pipeline::leaveSource(bool exhausted)
+{
+    Token* next = nullptr;
+
+    uint32_t retired = 0u;
+
+    {
+        std::lock_guard<std::mutex> lk{m_sourceMut};
+
+        if(exhausted)
+        {
+            m_sourceExhausted = true;
+
+            retired = static_cast<uint32_t>(m_idleTokens.size());
+
+            m_idleTokens.clear();
+        }
+        else if(!m_idleTokens.empty())
+        {
+            next = m_idleTokens.back();
+
+            m_idleTokens.pop_back();
+        }
+
+        m_sourceBusy = next != nullptr;
+    }
+
+    // the caller still holds its own token, so this never finishes the run
+    if(retired != 0u)
+    {
+        retire(retired);
+    }
+
+    if(next != nullptr)
+    {
+        spawn(next, 0u, true);
+    }
+}
+
+inline void Pipeline::retire(uint32_t count)
+{
+    if(m_liveTokens.fetch_sub(count, std::memory_order_acq_rel) == count)
+    {
+        m_done.set_value();
+    }
+}
\ No newline at end of file
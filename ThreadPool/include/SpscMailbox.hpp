@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread. Each side owns one index and
+// keeps a cached copy of the other's, so the shared cache lines are only touched when the cached view says the
+// ring looks full or empty.
+template<typename T> class SpscMailbox
+{
+    public:
+
+        // rounded up to a power of two
+        explicit SpscMailbox(size_t capacity);
+
+        SpscMailbox(const SpscMailbox& other) = delete;
+
+        SpscMailbox& operator=(const SpscMailbox& other) = delete;
+
+        // producer only, in_val is left untouched when the ring is full
+        bool tryPush(T&& in_val);
+
+        // consumer only
+        bool tryPop(T& out_val);
+
+        size_t capacity() const { return m_mask + 1u; }
+
+    private:
+
+        static constexpr size_t CACHE_LINE = 64u;
+
+        // read-only after construction, kept off the index lines so index writes never invalidate them
+        alignas(CACHE_LINE) std::unique_ptr<T[]> m_slots;
+
+        size_t m_mask;
+
+        // consumer line: next slot the consumer reads, written by the consumer only
+        alignas(CACHE_LINE) std::atomic<size_t> m_head{0u};
+
+        // consumer's view of m_tail
+        size_t m_cachedTail = 0u;
+
+        // producer line: next slot the producer writes, written by the producer only
+        alignas(CACHE_LINE) std::atomic<size_t> m_tail{0u};
+
+        // producer's view of m_head; the class alignment pads the rest of this line
+        size_t m_cachedHead = 0u;
+};
+
+#include "SpscMailbox.inl"
\ No newline at end of file
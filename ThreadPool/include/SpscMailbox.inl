@@ -0,0 +1,57 @@
+#pragma once
+
+template<typename T> SpscMailbox<T>::SpscMailbox(size_t capacity)
+{
+    size_t rounded = 1u;
+
+    while(rounded < capacity)
+    {
+        rounded <<= 1u;
+    }
+
+    m_slots.reset(new T[rounded]);
+
+    m_mask = rounded - 1u;
+}
+
+template<typename T> bool SpscMailbox<T>::tryPush(T&& in_val)
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    if(tail - m_cachedHead > m_mask)
+    {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+
+        if(tail - m_cachedHead > m_mask)
+        {
+            return false;
+        }
+    }
+
+    m_slots[tail & m_mask] = std::move(in_val);
+
+    m_tail.store(tail + 1u, std::memory_order_release);
+
+    return true;
+}
+
+template<typename T> bool SpscMailbox<T>::tryPop(T& out_val)
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+
+    if(head == m_cachedTail)
+    {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+        if(head == m_cachedTail)
+        {
+            return false;
+        }
+    }
+
+    out_val = std::move(m_slots[head & m_mask]);
+
+    m_head.store(head + 1u, std::memory_order_release);
+
+    return true;
+}
\ No newline at end of file
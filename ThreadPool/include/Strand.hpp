@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ThreadPool.hpp"
+
+// Serial executor layered over a ThreadPool: tasks posted to one strand run in posting order and never
+// concurrently, without a lock held while they run. Producers push onto an intrusive MPSC queue (Vyukov),
+// the producer that makes the strand non-empty schedules one turn on the pool, and a turn runs at most
+// batchSize tasks before re-posting itself, so a busy strand cannot monopolize a worker.
+// A strand holds no allocation of its own, thousands of them are fine.
+class Strand
+{
+    public:
+
+        static constexpr uint32_t DEFAULT_BATCH_SIZE = 64u;
+
+        explicit Strand(ThreadPool& pool, uint32_t batchSize = DEFAULT_BATCH_SIZE);
+
+        Strand(const Strand& other) = delete;
+
+        Strand& operator=(const Strand& other) = delete;
+
+        // waits for the queued tasks to finish, must not be called from a task of this strand
+        ~Strand();
+
+        // fire and forget, func must not throw
+        template<typename F> void post(F&& func);
+
+        template<typename F> ThreadPool::AsyncResult<F> execute(F&& func);
+
+        // true inside a task of this strand
+        bool runningInThisThread() const;
+
+        // posted tasks that have not finished yet
+        uint32_t pending() const;
+
+    private:
+
+        // the queue node is the task itself, one allocation per post
+        struct Node
+        {
+            std::atomic<Node*> next{nullptr};
+
+            virtual void invoke() {}
+
+            virtual ~Node() = default;
+        };
+
+        template<typename F> struct ImplNode : public Node
+        {
+            F m_func;
+
+            ImplNode(F&& func) : m_func{std::move(func)} {}
+
+            void invoke() override { m_func(); }
+        };
+
+        void push(Node* node);
+
+        // nullptr when empty or when a producer is halfway through its push
+        Node* pop();
+
+        void schedule();
+
+        void runBatch();
+
+        ThreadPool* m_pool;
+
+        uint32_t m_batchSize;
+
+        // producers exchange onto m_head, the single consumer walks m_tail
+        std::atomic<Node*> m_head;
+
+        Node* m_tail;
+
+        Node m_stub;
+
+        // posted and unfinished tasks, the 0 -> 1 transition schedules a turn
+        std::atomic<uint32_t> m_pending{0u};
+
+        inline static thread_local const Strand* s_current = nullptr;
+};
+
+#include "Strand.inl"
\ No newline at end of file
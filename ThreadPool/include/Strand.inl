@@ -0,0 +1,158 @@
+#pragma once
+
+inline Strand::Strand(ThreadPool& pool, uint32_t batchSize) : m_pool{&pool}, m_batchSize{batchSize}, m_head{&m_stub}, m_tail{&m_stub}
+{
+    DEBUG_ASSERT(batchSize != 0u);
+}
+
+inline Strand::~Strand()
+{
+    DEBUG_ASSERT(s_current != this);
+
+    while(m_pending.load(std::memory_order_acquire) != 0u)
+    {
+        std::this_thread::yield();
+    }
+}
+
+template<typename F> void Strand::post(F&& func)
+{
+    push(new ImplNode<F>{std::move(func)});
+}
+
+template<typename F> ThreadPool::AsyncResult<F> Strand::execute(F&& func)
+{
+    typedef typename std::result_of<F()>::type FunctionType;
+
+    std::packaged_task<FunctionType()> task{std::move(func)};
+
+    std::future<FunctionType> result{task.get_future()};
+
+    post(std::move(task));
+
+    return result;
+}
+
+inline bool Strand::runningInThisThread() const
+{
+    return s_current == this;
+}
+
+inline uint32_t Strand::pending() const
+{
+    return m_pending.load(std::memory_order_acquire);
+}
+
+inline void Strand::push(Node* node)
+{
+    // counted before it is linked, so a turn never pops more tasks than m_pending holds
+    const uint32_t pending = m_pending.fetch_add(1u, std::memory_order_acq_rel);
+
+    node->next.store(nullptr, std::memory_order_relaxed);
+
+    Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+
+    prev->next.store(node, std::memory_order_release);
+
+    if(pending == 0u)
+    {
+        schedule();
+    }
+}
+
+inline Strand::Node* Strand::pop()
+{
+    Node* tail = m_tail;
+
+    Node* next = tail->next.load(std::memory_order_acquire);
+
+    if(tail == &m_stub)
+    {
+        if(next == nullptr)
+        {
+            return nullptr;
+        }
+
+        m_tail = next;
+
+        tail = next;
+
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if(next != nullptr)
+    {
+        m_tail = next;
+
+        return tail;
+    }
+
+    if(tail != m_head.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    // tail is the last node, the stub goes behind it so tail can be handed out
+    m_stub.next.store(nullptr, std::memory_order_relaxed);
+
+    Node* prev = m_head.exchange(&m_stub, std::memory_order_acq_rel);
+
+    prev->next.store(&m_stub, std::memory_order_release);
+
+    next = tail->next.load(std::memory_order_acquire);
+
+    if(next != nullptr)
+    {
+        m_tail = next;
+
+        return tail;
+    }
+
+    return nullptr;
+}
+
+inline void Strand::schedule()
+{
+    m_pool->executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([this]() -> void { runBatch(); }));
+}
+
+inline void Strand::runBatch()
+{
+    const Strand* previous = s_current;
+
+    s_current = this;
+
+    uint32_t done = 0u;
+
+    while(done < m_batchSize)
+    {
+        Node* node = pop();
+
+        if(node == nullptr)
+        {
+            // m_pending counts a task whose producer has not linked it yet, it shows up shortly
+            if(done == 0u)
+            {
+                std::this_thread::yield();
+
+                continue;
+            }
+
+            break;
+        }
+
+        node->invoke();
+
+        delete node;
+
+        ++done;
+    }
+
+    s_current = previous;
+
+    // whoever takes the count to zero ends the turn, a later post schedules a new one
+    if(m_pending.fetch_sub(done, std::memory_order_acq_rel) != done)
+    {
+        schedule();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+// Opt-in micro-task coalescing for one producer. Tasks submitted through a coalescer are collected and
+// handed to the pool as a single queue entry that runs them back to back, so a tiny task no longer pays a
+// queue push, a steal and a wakeup of its own. The batch size adapts to the measured run time of finished
+// batches, aiming at TARGET_BATCH_NS per entry: tiny tasks get packed by the hundreds, tasks that are long
+// enough on their own go out one at a time.
+// Each coalesced task runs through Worker::runTask, so barriers, the continuation policy, tracing,
+// histograms, workload recording and the arena reset treat it like a task of its own. A partial batch is held back until the
+// batch fills, MAX_HOLD_NS passed since its first task, flush() or the destructor, so flush before waiting
+// on one of its results. Not thread-safe, every producer thread uses its own coalescer.
+class TaskCoalescer
+{
+    public:
+
+        static constexpr uint64_t TARGET_BATCH_NS = 50000u;
+
+        static constexpr uint64_t MAX_HOLD_NS = 200000u;
+
+        static constexpr uint32_t HOLD_CHECK_INTERVAL = 16u;
+
+        static constexpr uint32_t INITIAL_BATCH_SIZE = 8u;
+
+        static constexpr uint32_t MAX_BATCH_SIZE = 1024u;
+
+        explicit TaskCoalescer(ThreadPool& pool);
+
+        TaskCoalescer(const TaskCoalescer& other) = delete;
+
+        TaskCoalescer& operator=(const TaskCoalescer& other) = delete;
+
+        ~TaskCoalescer();
+
+        template<typename F> ThreadPool::AsyncResult<F> submit(F&& func);
+
+        void submit(ThreadPool::FunctionWrapper::Ptr&& wrappedTask);
+
+        // hands the current partial batch to the pool
+        void flush();
+
+        // tasks per entry the next batch aims for
+        uint32_t batchSize() const;
+
+    private:
+
+        // written by the batches, read by the producer when it sizes the next one
+        struct Stats
+        {
+            // exponential moving average of the per-task run time, 0 until the first batch finished
+            std::atomic<uint64_t> taskNs{0u};
+        };
+
+        // on a worker, every task goes through Worker::runTask as if popped from a queue
+        static void runBatch(Stats& stats, std::vector<ThreadPool::FunctionWrapper::Ptr>& tasks);
+
+        ThreadPool* m_pool;
+
+        std::shared_ptr<Stats> m_stats;
+
+        std::vector<ThreadPool::FunctionWrapper::Ptr> m_batch;
+
+        uint64_t m_batchStart = 0u;
+
+        uint32_t m_batchSize = INITIAL_BATCH_SIZE;
+};
+
+#include "TaskCoalescer.inl"
\ No newline at end of file
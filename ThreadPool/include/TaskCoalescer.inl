@@ -0,0 +1,114 @@
+#pragma once
+
+inline TaskCoalescer::TaskCoalescer(ThreadPool& pool) : m_pool{&pool}, m_stats{std::make_shared<Stats>()}
+{
+    m_batch.reserve(m_batchSize);
+}
+
+inline TaskCoalescer::~TaskCoalescer()
+{
+    flush();
+}
+
+template<typename F> ThreadPool::AsyncResult<F> TaskCoalescer::submit(F&& func)
+{
+    ThreadPool::FunctionWrapper::Ptr wrappedTask;
+
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    submit(std::move(wrappedTask));
+
+    return result;
+}
+
+inline void TaskCoalescer::submit(ThreadPool::FunctionWrapper::Ptr&& wrappedTask)
+{
+    if(m_batch.empty())
+    {
+        m_batchStart = ThreadPool::now();
+    }
+
+    // submitted now as far as tracing, histograms and recording are concerned, the hold time counts as queue wait
+    ThreadPool::Worker::onEnqueue(wrappedTask);
+
+    m_batch.push_back(std::move(wrappedTask));
+
+    // reading the clock costs about as much as a tiny task, the hold time is only checked every few tasks
+    if(m_batch.size() >= m_batchSize || (m_batch.size() % HOLD_CHECK_INTERVAL == 0u && ThreadPool::now() - m_batchStart >= MAX_HOLD_NS))
+    {
+        flush();
+    }
+}
+
+inline void TaskCoalescer::flush()
+{
+    if(m_batch.empty())
+    {
+        return;
+    }
+
+    ThreadPool::FunctionWrapper::Ptr batchTask;
+
+    if(m_batch.size() == 1u)
+    {
+        // nothing to pack, and its barrier, continuation and task info stay on the queue entry itself
+        batchTask = std::move(m_batch.front());
+    }
+    else
+    {
+        batchTask = std::make_unique<ThreadPool::FunctionWrapper>([stats = m_stats, tasks = std::move(m_batch)]() mutable -> void
+        {
+            runBatch(*stats, tasks);
+        });
+
+        batchTask->info().name = "TaskCoalescer batch";
+
+        batchTask->info().container = true;
+    }
+
+    m_batch.clear();
+
+    // counts as one entry towards the pool capacity; a producer inside a pool task must not block on it
+    if(ThreadPool::isWorkerThread())
+    {
+        m_pool->executeAsync(std::move(batchTask));
+    }
+    else
+    {
+        m_pool->submit(std::move(batchTask));
+    }
+
+    const uint64_t taskNs = m_stats->taskNs.load(std::memory_order_relaxed);
+
+    if(taskNs != 0u)
+    {
+        m_batchSize = static_cast<uint32_t>(std::clamp<uint64_t>(TARGET_BATCH_NS / taskNs, 1u, MAX_BATCH_SIZE));
+    }
+
+    m_batch.reserve(m_batchSize);
+}
+
+inline uint32_t TaskCoalescer::batchSize() const
+{
+    return m_batchSize;
+}
+
+inline void TaskCoalescer::runBatch(Stats& stats, std::vector<ThreadPool::FunctionWrapper::Ptr>& tasks)
+{
+    const uint64_t startTime = ThreadPool::now();
+
+    ThreadPool::Worker& worker = ThreadPool::currentWorker();
+
+    // the worker's own path: tracing, histograms, recording, the arena reset and the continuation policy
+    for(auto& task : tasks)
+    {
+        worker.runTask(task);
+    }
+
+    const uint64_t sample = std::max<uint64_t>(1u, (ThreadPool::now() - startTime) / tasks.size());
+
+    // lost updates between concurrent batches only drop a sample
+    const uint64_t previous = stats.taskNs.load(std::memory_order_relaxed);
+
+    stats.taskNs.store(previous == 0u ? sample : previous - previous / 8u + sample / 8u, std::memory_order_relaxed);
+}
\ No newline at end of file
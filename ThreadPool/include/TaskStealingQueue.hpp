@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <deque>
 #include <thread>
 #include <condition_variable>
@@ -16,6 +17,11 @@ template<typename T> class TaskStealingQueue
 
     std::condition_variable m_cv;
 
+    // m_queue.size() as of the last push or pop, readable without the lock
+    std::atomic<size_t> m_approximateSize{0u};
+
+    void updateApproximateSize() { m_approximateSize.store(m_queue.size(), std::memory_order_relaxed); }
+
 public:
 
     TaskStealingQueue() = default;
@@ -35,6 +41,9 @@ public:
 
     size_t size();
 
+    // may lag behind concurrent pushes and pops, meant for placement heuristics
+    size_t approximateSize() const { return m_approximateSize.load(std::memory_order_relaxed); }
+
     bool empty();
 };
 
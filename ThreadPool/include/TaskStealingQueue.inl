@@ -6,6 +6,8 @@ template<typename T> TaskStealingQueue<T>& TaskStealingQueue<T>::pushFront(T&& i
 
     m_queue.push_front(std::forward<T>(in_val));
 
+    updateApproximateSize();
+
     m_cv.notify_one();
 
     return *this;
@@ -22,6 +24,8 @@ template<typename T> bool TaskStealingQueue<T>::tryPushFront(T&& in_val)
 
     m_queue.push_front(std::forward<T>(in_val));
 
+    updateApproximateSize();
+
     m_cv.notify_one();
 
     return true;
@@ -40,6 +44,8 @@ template<typename T> bool TaskStealingQueue<T>::tryPopFront(T& out_val)
 
     m_queue.pop_front();
 
+    updateApproximateSize();
+
     return true;
 }
 
@@ -47,7 +53,8 @@ template<typename T> bool TaskStealingQueue<T>::tryPopBack(T& out_val)
 {
     std::unique_lock<std::mutex> lk{m_mutex, std::try_to_lock};
 
-    if(m_queue.size() < 1u || !lk)
+    // the lock first, a thief that lost the race for it must not look at the deque
+    if(!lk || m_queue.empty())
     {
         return false;
     }
@@ -56,6 +63,8 @@ template<typename T> bool TaskStealingQueue<T>::tryPopBack(T& out_val)
 
     m_queue.pop_back();
 
+    updateApproximateSize();
+
     return true;
 }
 
@@ -68,6 +77,8 @@ template<typename T> void TaskStealingQueue<T>::popFront(T& out_val)
     out_val = std::move(m_queue.front());
 
     m_queue.pop_front();
+
+    updateApproximateSize();
 }
 
 template<typename T> void TaskStealingQueue<T>::popBack(T& out_val)
@@ -79,6 +90,8 @@ template<typename T> void TaskStealingQueue<T>::popBack(T& out_val)
     out_val = std::move(m_queue.back());
 
     m_queue.pop_back();
+
+    updateApproximateSize();
 }
 
 template<typename T> size_t TaskStealingQueue<T>::size()
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Task timeline tracing. Compiled in only when THREADPOOL_TRACING is defined to a non-zero value,
+// otherwise every THREADPOOL_TRACE* macro expands to nothing.
+#ifndef THREADPOOL_TRACING
+    #define THREADPOOL_TRACING 0
+#endif
+
+class TaskTracer
+{
+    public:
+
+        enum class EventType : uint8_t
+        {
+            ENQUEUE,
+            TASK_BEGIN,
+            TASK_END,
+            STEAL,
+            PARK,
+            UNPARK,
+            RANGE_BEGIN,
+            RANGE_END
+        };
+
+        struct Event
+        {
+            uint64_t timestamp;
+
+            const char* name;
+
+            uint64_t id;
+
+            EventType type;
+        };
+
+        // single writer (the owning thread), overwrites the oldest events once full
+        class RingBuffer
+        {
+            private:
+
+                std::vector<Event> m_events;
+
+                uint64_t m_mask;
+
+                std::atomic<uint64_t> m_head{0u};
+
+                uint32_t m_threadId;
+
+                std::string m_threadName;
+
+            public:
+
+                RingBuffer(size_t capacity, uint32_t threadId);
+
+                void push(const Event& event);
+
+                void snapshot(std::vector<Event>& outEvents) const;
+
+                void clear();
+
+                friend class TaskTracer;
+        };
+
+        // records a named range on the calling thread for the lifetime of the object
+        class ScopedRange
+        {
+            public:
+
+                explicit ScopedRange(const char* name);
+
+                ~ScopedRange();
+
+                ScopedRange(const ScopedRange&) = delete;
+
+                ScopedRange& operator=(const ScopedRange&) = delete;
+
+            private:
+
+                const char* m_name;
+        };
+
+        static void record(EventType type, const char* name, uint64_t id = 0u);
+
+        static uint64_t nextTaskId();
+
+        static void setThreadName(const std::string& name);
+
+        // affects only threads that have not recorded anything yet, rounded up to a power of two
+        static void setBufferCapacity(size_t capacity);
+
+        static bool dumpJson(const std::string& path);
+
+        static void clear();
+
+        static uint64_t now();
+
+    private:
+
+        static RingBuffer& localBuffer();
+
+        inline static std::mutex s_registryMutex;
+
+        inline static std::vector<std::shared_ptr<RingBuffer>> s_buffers;
+
+        inline static std::atomic<size_t> s_capacity{1u << 16};
+
+        inline static std::atomic<uint64_t> s_taskId{0u};
+};
+
+#define THREADPOOL_TRACE_CONCAT_IMPL(a, b) a##b
+#define THREADPOOL_TRACE_CONCAT(a, b) THREADPOOL_TRACE_CONCAT_IMPL(a, b)
+
+#if THREADPOOL_TRACING
+    #define THREADPOOL_TRACE(type, name, id) TaskTracer::record(TaskTracer::EventType::type, name, id)
+    #define THREADPOOL_TRACE_RANGE(name) TaskTracer::ScopedRange THREADPOOL_TRACE_CONCAT(traceRange, __LINE__){name}
+    #define THREADPOOL_TRACE_THREAD_NAME(name) TaskTracer::setThreadName(name)
+#else
+    #define THREADPOOL_TRACE(type, name, id)
+    #define THREADPOOL_TRACE_RANGE(name)
+    #define THREADPOOL_TRACE_THREAD_NAME(name)
+#endif
+
+#include "TaskTracer.inl"
\ No newline at end of file
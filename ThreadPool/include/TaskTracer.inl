@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+
+inline TaskTracer::RingBuffer::RingBuffer(size_t capacity, uint32_t threadId) : m_threadId{threadId}, m_threadName{"thread " + std::to_string(threadId)}
+{
+    size_t roundedCapacity = 1u;
+
+    while(roundedCapacity < capacity)
+    {
+        roundedCapacity <<= 1u;
+    }
+
+    m_events.resize(roundedCapacity);
+
+    m_mask = roundedCapacity - 1u;
+}
+
+inline void TaskTracer::RingBuffer::push(const Event& event)
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+
+    m_events[head & m_mask] = event;
+
+    m_head.store(head + 1u, std::memory_order_release);
+}
+
+inline void TaskTracer::RingBuffer::snapshot(std::vector<Event>& outEvents) const
+{
+    // the owning thread may still be writing, so the oldest few events of a full buffer can be torn;
+    // dump while the pool is paused for an exact trace
+    uint64_t head = m_head.load(std::memory_order_acquire);
+
+    uint64_t count = std::min<uint64_t>(head, m_events.size());
+
+    for(uint64_t i = head - count; i < head; ++i)
+    {
+        outEvents.push_back(m_events[i & m_mask]);
+    }
+}
+
+inline void TaskTracer::RingBuffer::clear()
+{
+    m_head.store(0u, std::memory_order_release);
+}
+
+inline TaskTracer::ScopedRange::ScopedRange(const char* name) : m_name{name}
+{
+    record(EventType::RANGE_BEGIN, m_name);
+}
+
+inline TaskTracer::ScopedRange::~ScopedRange()
+{
+    record(EventType::RANGE_END, m_name);
+}
+
+inline uint64_t TaskTracer::now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline TaskTracer::RingBuffer& TaskTracer::localBuffer()
+{
+    // the registry shares ownership so events of finished threads survive until the dump
+    thread_local std::shared_ptr<RingBuffer> buffer = []() -> std::shared_ptr<RingBuffer>
+    {
+        std::lock_guard<std::mutex> lk{s_registryMutex};
+
+        auto result = std::make_shared<RingBuffer>(s_capacity.load(), static_cast<uint32_t>(s_buffers.size()));
+
+        s_buffers.push_back(result);
+
+        return result;
+    }();
+
+    return *buffer;
+}
+
+inline void TaskTracer::record(EventType type, const char* name, uint64_t id)
+{
+    localBuffer().push(Event{now(), name, id, type});
+}
+
+inline uint64_t TaskTracer::nextTaskId()
+{
+    return s_taskId.fetch_add(1u, std::memory_order_relaxed) + 1u;
+}
+
+inline void TaskTracer::setThreadName(const std::string& name)
+{
+    RingBuffer& buffer = localBuffer();
+
+    std::lock_guard<std::mutex> lk{s_registryMutex};
+
+    buffer.m_threadName = name;
+}
+
+inline void TaskTracer::setBufferCapacity(size_t capacity)
+{
+    s_capacity = std::max<size_t>(capacity, 1u);
+}
+
+inline void TaskTracer::clear()
+{
+    std::lock_guard<std::mutex> lk{s_registryMutex};
+
+    for(auto& buffer : s_buffers)
+    {
+        buffer->clear();
+    }
+}
+
+inline bool TaskTracer::dumpJson(const std::string& path)
+{
+    std::ofstream out{path};
+
+    if(!out)
+    {
+        return false;
+    }
+
+    auto writeString = [&out](const char* str) -> void
+    {
+        out << '"';
+
+        for(const char* c = str; *c != '\0'; ++c)
+        {
+            if(*c == '"' || *c == '\\')
+            {
+                out << '\\';
+            }
+
+            if(static_cast<unsigned char>(*c) >= 0x20u)
+            {
+                out << *c;
+            }
+        }
+
+        out << '"';
+    };
+
+    std::lock_guard<std::mutex> lk{s_registryMutex};
+
+    std::vector<std::vector<Event>> threadEvents(s_buffers.size());
+
+    uint64_t origin = UINT64_MAX;
+
+    for(size_t i = 0u; i < s_buffers.size(); ++i)
+    {
+        s_buffers[i]->snapshot(threadEvents[i]);
+
+        if(!threadEvents[i].empty())
+        {
+            origin = std::min(origin, threadEvents[i].front().timestamp);
+        }
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    bool first = true;
+
+    auto beginEvent = [&](const char* name, const char* category, const char* phase, uint32_t tid, uint64_t timestamp) -> void
+    {
+        out << (first ? "" : ",\n") << "{\"name\":";
+
+        first = false;
+
+        writeString(name);
+
+        out << ",\"cat\":\"" << category << "\",\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":" << tid
+            << ",\"ts\":" << static_cast<double>(timestamp - origin) / 1000.;
+    };
+
+    for(size_t i = 0u; i < s_buffers.size(); ++i)
+    {
+        const RingBuffer& buffer = *s_buffers[i];
+
+        beginEvent("thread_name", "__metadata", "M", buffer.m_threadId, origin);
+
+        out << ",\"args\":{\"name\":";
+
+        writeString(buffer.m_threadName.c_str());
+
+        out << "}}";
+
+        for(const Event& event : threadEvents[i])
+        {
+            const char* name = event.name != nullptr ? event.name : "task";
+
+            switch(event.type)
+            {
+                case EventType::ENQUEUE:
+                    beginEvent(name, "enqueue", "i", buffer.m_threadId, event.timestamp);
+                    out << ",\"s\":\"t\",\"args\":{\"task\":" << event.id << "}}";
+                    beginEvent("task", "flow", "s", buffer.m_threadId, event.timestamp);
+                    out << ",\"id\":" << event.id << "}";
+                    break;
+
+                case EventType::TASK_BEGIN:
+                    beginEvent(name, "task", "B", buffer.m_threadId, event.timestamp);
+                    out << ",\"args\":{\"task\":" << event.id << "}}";
+                    beginEvent("task", "flow", "f", buffer.m_threadId, event.timestamp);
+                    out << ",\"bp\":\"e\",\"id\":" << event.id << "}";
+                    break;
+
+                case EventType::TASK_END:
+                    beginEvent(name, "task", "E", buffer.m_threadId, event.timestamp);
+                    out << "}";
+                    break;
+
+                case EventType::STEAL:
+                    beginEvent("steal", "steal", "i", buffer.m_threadId, event.timestamp);
+                    out << ",\"s\":\"t\",\"args\":{\"victim\":" << event.id << "}}";
+                    break;
+
+                case EventType::PARK:
+                    beginEvent("idle", "park", "B", buffer.m_threadId, event.timestamp);
+                    out << "}";
+                    break;
+
+                case EventType::UNPARK:
+                    beginEvent("idle", "park", "E", buffer.m_threadId, event.timestamp);
+                    out << "}";
+                    break;
+
+                case EventType::RANGE_BEGIN:
+                    beginEvent(name, "range", "B", buffer.m_threadId, event.timestamp);
+                    out << "}";
+                    break;
+
+                case EventType::RANGE_END:
+                    beginEvent(name, "range", "E", buffer.m_threadId, event.timestamp);
+                    out << "}";
+                    break;
+            }
+        }
+    }
+
+    out << "\n]}\n";
+
+    return static_cast<bool>(out);
+}
\ No newline at end of file
@@ -1,17 +1,29 @@
 #pragma once
 
 #include <thread>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <deque>
 #include <vector>
 #include <future>
 #include <memory>
+#include <optional>
 #include <unordered_map>
+#include <string>
 
 #include "TaskStealingQueue.hpp"
+#include "SpscMailbox.hpp"
+#include "TaskTracer.hpp"
+#include "LatencyHistogram.hpp"
+#include "WorkloadRecorder.hpp"
+#include "CpuQuota.hpp"
+#include "WorkerArena.hpp"
 #include "debug.hpp"
 
+template<typename T> class Future;
+
 class ThreadPool
 {
 
@@ -19,6 +31,56 @@ public:
 
     class Barrier;
 
+    class Worker;
+
+    // how executeAsync picks the queue for a new task
+    enum class PlacementPolicy
+    {
+        // next worker in turn
+        ROUND_ROBIN,
+        // the less loaded of two random workers, keeps tasks away from workers stuck on long ones
+        POWER_OF_TWO_CHOICES
+    };
+
+    // where the continuation set up by chainTask runs once its predecessor finished
+    enum class ContinuationPolicy
+    {
+        // right away on the same worker while the predecessor's data is still in its cache, at most
+        // MAX_INLINE_CONTINUATIONS tasks of a chain back to back, then LOCAL
+        INLINE,
+        // next in line on the same worker's queue, other workers may steal it
+        LOCAL,
+        // through executeAsync like any new task
+        REDISTRIBUTE
+    };
+
+    // outcome of one checkThrottling() sample
+    struct ThrottleReport
+    {
+        // share of the CFS periods since the previous sample in which the cgroup got throttled
+        double throttledFraction = 0.;
+
+        uint64_t throttledNs = 0u;
+
+        uint32_t activeWorkers = 0u;
+
+        // throttledFraction above THROTTLE_THRESHOLD
+        bool oversubscribed = false;
+    };
+
+    // optional per-task metadata, name must outlive the task (string literals are fine)
+    struct TaskInfo
+    {
+        const char* name = nullptr;
+
+        // latency histogram bucket, values past THREADPOOL_MAX_TASK_CLASSES are folded into the last class
+        uint32_t taskClass = 0u;
+
+        // the task only runs other tasks through Worker::runTask, like a TaskCoalescer batch; those are measured
+        // and recorded on their own, so the container is left out of histograms and workload records
+        bool container = false;
+    };
+
     class FunctionWrapper
     {
         public:
@@ -50,13 +112,27 @@ public:
 
             Barrier* m_pBarrier = nullptr;
 
+            TaskInfo m_info;
+
+#if THREADPOOL_TRACING
+            uint64_t m_traceId = 0u;
+#endif
+
+#if THREADPOOL_HISTOGRAMS
+            uint64_t m_enqueueTime = 0u;
+#endif
+
+#if THREADPOOL_RECORDING
+            WorkloadRecorder::TaskRecord m_record;
+#endif
+
         public:
 
             template<typename F> FunctionWrapper(F&& f) : m_impl{new ImplType<F>(std::move(f))} {}
 
             FunctionWrapper() = default;
 
-            FunctionWrapper(FunctionWrapper&& rr, Barrier* pBarrier = nullptr) : m_impl{std::move(rr.m_impl)}, m_then{std::move(rr.m_then)}, m_pBarrier{pBarrier} {}
+            FunctionWrapper(FunctionWrapper&& rr, Barrier* pBarrier = nullptr) : m_impl{std::move(rr.m_impl)}, m_then{std::move(rr.m_then)}, m_pBarrier{pBarrier}, m_info{rr.m_info} {}
 
             FunctionWrapper& operator=(FunctionWrapper&& rr)
             {
@@ -68,6 +144,8 @@ public:
 
                 rr.m_pBarrier = nullptr;
 
+                m_info = rr.m_info;
+
                 return *this;
             }
 
@@ -81,6 +159,11 @@ public:
                 return m_pBarrier;
             }
 
+            TaskInfo& info()
+            {
+                return m_info;
+            }
+
             FunctionWrapper(const FunctionWrapper& other) = delete;
 
             FunctionWrapper& operator=(const FunctionWrapper& other) = delete;
@@ -100,12 +183,17 @@ public:
 
     template<typename F> using AsyncResult = std::future<typename std::result_of<F()>::type>;
 
+    // continuable future, see Future.hpp
+    template<typename F> using FutureResult = Future<typename std::result_of<F()>::type>;
+
     template<typename F> using AsyncResultAndFuncWrapper = std::pair<AsyncResult<F>, FunctionWrapper::Ptr*>;
 
     class Worker
     {
         private:
 
+            using Mailbox = SpscMailbox<FunctionWrapper::Ptr>;
+
             ThreadPool* m_poolPtr;
 
             std::unique_ptr<TaskStealingQueue<FunctionWrapper::Ptr>> m_tasks;
@@ -116,14 +204,51 @@ public:
 
             std::atomic<bool> m_busy = false;
 
+            // only while a task runs, for placement; m_busy also covers idle passes
+            std::atomic<bool> m_running = false;
+
+#if THREADPOOL_HISTOGRAMS
+            std::unique_ptr<TaskLatencyRecorder> m_latency = std::make_unique<TaskLatencyRecorder>();
+#endif
+
+            std::unique_ptr<WorkerArena> m_arena;
+
+            // Shard tasks pinned to this worker, never stolen. One mailbox per producing worker, indexed by its
+            // id and created by that producer on first use, plus a locked inbox for threads outside the pool.
+            uint32_t m_workerCount;
+
+            std::unique_ptr<std::atomic<Mailbox*>[]> m_mailboxes;
+
+            std::unique_ptr<TaskStealingQueue<FunctionWrapper::Ptr>> m_shardInbox;
+
+            // mailbox the next shard pop starts at, so no producer can starve the others
+            uint32_t m_nextMailbox = 0u;
+
+            // shard tasks this worker produced that did not fit the target's mailbox, indexed by target and
+            // drained in order before anything newer goes through the mailbox
+            std::vector<std::deque<FunctionWrapper::Ptr>> m_shardOverflow;
+
+            size_t m_shardOverflowCount = 0u;
+
             std::unique_ptr<std::thread> m_thread;
 
         public:
 
             Worker() = default;
 
-            template<typename ReturnType, typename... Args> Worker(uint32_t ID, ThreadPool* poolPtr, ReturnType&& func, Args&&... args) : m_poolPtr{poolPtr}, m_tasks{new TaskStealingQueue<FunctionWrapper::Ptr>{}}, m_thread{new std::thread{std::forward<ReturnType>(func), this, std::forward<Args>(args)...}}, m_threadId{ID}, m_done{false}  
+            template<typename ReturnType, typename... Args> Worker(uint32_t ID, uint32_t workerCount, ThreadPool* poolPtr, ReturnType&& func, Args&&... args) : m_poolPtr{poolPtr}, m_tasks{new TaskStealingQueue<FunctionWrapper::Ptr>{}}, m_threadId{ID}, m_done{false}, m_arena{new WorkerArena{poolPtr->m_arenaSize}}, m_workerCount{workerCount}, m_mailboxes{new std::atomic<Mailbox*>[workerCount]()}, m_shardInbox{new TaskStealingQueue<FunctionWrapper::Ptr>{}}, m_shardOverflow(workerCount), m_thread{new std::thread{std::forward<ReturnType>(func), this, std::forward<Args>(args)...}}
+            {
+            }
+
+            // scratch memory for the running task, released once the top-level task returns
+            WorkerArena& arena()
+            {
+                return *m_arena;
+            }
+
+            uint32_t id() const
             {
+                return m_threadId;
             }
 
             bool trySteal(FunctionWrapper::Ptr& outFunc)
@@ -158,6 +283,8 @@ public:
 
                     if(m_poolPtr->m_workers[stealFromID]->trySteal(task))
                     {
+                        THREADPOOL_TRACE(STEAL, nullptr, stealFromID);
+
                         return true;
                     }
                 }
@@ -165,38 +292,235 @@ public:
                 return false;
             }
 
+            // the mailbox producer hands this worker shard tasks through, must only be called on producer's thread
+            Mailbox& mailboxFrom(uint32_t producer)
+            {
+                Mailbox* mailbox = m_mailboxes[producer].load(std::memory_order_relaxed);
+
+                if(mailbox == nullptr)
+                {
+                    mailbox = new Mailbox{ThreadPool::SHARD_MAILBOX_CAPACITY};
+
+                    m_mailboxes[producer].store(mailbox, std::memory_order_release);
+                }
+
+                return *mailbox;
+            }
+
+            // called on this worker's thread for a shard task owned by target
+            void sendToShard(Worker& target, FunctionWrapper::Ptr&& task)
+            {
+                std::deque<FunctionWrapper::Ptr>& overflow = m_shardOverflow[target.m_threadId];
+
+                // a full mailbox never blocks the producer, two workers filling each other's would deadlock
+                if(!overflow.empty() || !target.mailboxFrom(m_threadId).tryPush(std::move(task)))
+                {
+                    overflow.push_back(std::move(task));
+
+                    ++m_shardOverflowCount;
+                }
+            }
+
+            void flushShardOverflow()
+            {
+                for(uint32_t target = 0u; m_shardOverflowCount != 0u && target < m_workerCount; ++target)
+                {
+                    std::deque<FunctionWrapper::Ptr>& overflow = m_shardOverflow[target];
+
+                    while(!overflow.empty() && m_poolPtr->m_workers[target]->mailboxFrom(m_threadId).tryPush(std::move(overflow.front())))
+                    {
+                        overflow.pop_front();
+
+                        --m_shardOverflowCount;
+                    }
+                }
+            }
+
+            bool popShardTask(FunctionWrapper::Ptr& task)
+            {
+                flushShardOverflow();
+
+                for(uint32_t i = 0u; i < m_workerCount; ++i)
+                {
+                    const uint32_t producer = (m_nextMailbox + i) % m_workerCount;
+
+                    Mailbox* mailbox = m_mailboxes[producer].load(std::memory_order_acquire);
+
+                    if(mailbox != nullptr && mailbox->tryPop(task))
+                    {
+                        m_nextMailbox = producer + 1u;
+
+                        return true;
+                    }
+                }
+
+                return m_shardInbox->approximateSize() != 0u && m_shardInbox->tryPopBack(task);
+            }
+
+            // runs task and the continuations the policy keeps on this worker, hands the rest of the chain on
             void runTask(FunctionWrapper::Ptr& task)
             {
+                for(uint32_t depth = 1u; ; ++depth)
+                {
+                    invokeTask(task);
+
+                    FunctionWrapper::Ptr next = std::move(task->then());
+
+                    if(next == nullptr)
+                    {
+                        return;
+                    }
+
+                    const ContinuationPolicy policy = m_poolPtr->m_continuationPolicy.load(std::memory_order_relaxed);
+
+                    if(policy == ContinuationPolicy::INLINE && depth < ThreadPool::MAX_INLINE_CONTINUATIONS)
+                    {
+                        onEnqueue(next);
+
+                        task = std::move(next);
+                    }
+                    else if(policy == ContinuationPolicy::REDISTRIBUTE)
+                    {
+                        m_poolPtr->executeAsync(std::move(next));
+
+                        return;
+                    }
+                    else
+                    {
+                        // the front of the local queue is what this worker pops next, the back is what gets stolen
+                        m_poolPtr->m_queuedTasks.fetch_add(1u);
+
+                        addTask(std::move(next));
+
+                        return;
+                    }
+                }
+            }
+
+            void invokeTask(FunctionWrapper::Ptr& task)
+            {
+                THREADPOOL_TRACE(TASK_BEGIN, task->m_info.name, task->m_traceId);
+
+#if THREADPOOL_HISTOGRAMS || THREADPOOL_RECORDING
+                const bool measured = !task->m_info.container;
+#endif
+
+#if THREADPOOL_HISTOGRAMS
+                uint32_t taskClass = std::min<uint32_t>(task->m_info.taskClass, THREADPOOL_MAX_TASK_CLASSES - 1u);
+
+                uint64_t startTime = ThreadPool::now();
+
+                if(measured)
+                {
+                    m_latency->queueWait[taskClass].record(startTime - task->m_enqueueTime);
+                }
+#endif
+
+#if THREADPOOL_RECORDING
+                WorkloadRecorder::TaskRecord& record = task->m_record;
+
+                if(measured)
+                {
+                    // read up front, the task may complete and delete its barrier
+                    record.barrier = task->m_pBarrier != nullptr ? task->m_pBarrier->recordId() : 0u;
+
+                    record.worker = static_cast<uint16_t>(m_threadId);
+
+                    record.startNs = WorkloadRecorder::now();
+
+                    WorkloadRecorder::setRunningTask(record.id);
+                }
+#endif
+
                 (*task)();
 
-                if(task->then() != nullptr)
+#if THREADPOOL_HISTOGRAMS
+                if(measured)
                 {
-                    m_poolPtr->executeAsync(std::forward<FunctionWrapper::Ptr>(task->then()));
+                    m_latency->execution[taskClass].record(ThreadPool::now() - startTime);
+                }
+#endif
+
+#if THREADPOOL_RECORDING
+                if(measured)
+                {
+                    record.runNs = WorkloadRecorder::now() - record.startNs;
+
+                    WorkloadRecorder::setRunningTask(0u);
+
+                    WorkloadRecorder::record(record);
+
+                    if(task->then() != nullptr)
+                    {
+                        task->then()->m_record.parent = record.id;
+
+                        task->then()->m_record.dependency = WorkloadRecorder::Dependency::CHAINED;
+                    }
                 }
+#endif
+
+                THREADPOOL_TRACE(TASK_END, task->m_info.name, task->m_traceId);
+
+                m_arena->reset();
             }
 
             void run()
             {
+                THREADPOOL_TRACE_THREAD_NAME("ThreadPool worker " + std::to_string(m_threadId));
+
+                s_currentWorker = this;
+
+                bool idle = false;
+
                 while(!m_done)
                 {
-                    std::unique_lock<std::mutex> lk{m_poolPtr->m_mut};
+                    if(m_poolPtr->m_paused)
+                    {
+                        std::unique_lock<std::mutex> lk{m_poolPtr->m_mut};
 
-                    m_poolPtr->m_cv.wait(lk, [this]()->bool { return !m_poolPtr->m_paused; });
+                        m_poolPtr->m_cv.wait(lk, [this]()->bool { return !m_poolPtr->m_paused; });
+                    }
 
+                    // covers the whole pass over the queues, a paused pool is settled once no worker is busy
                     m_busy = true;
 
+                    const bool active = m_threadId < m_poolPtr->m_activeWorkers.load(std::memory_order_relaxed);
+
                     FunctionWrapper::Ptr task{};
-                    
-                    if(popFromLocalQueue(task))
+
+                    // shard tasks come first, no other worker can run them
+                    if(popShardTask(task) || (active && (popFromLocalQueue(task) || popFromOtherWorker(task))))
                     {
+                        m_poolPtr->onDequeue();
+
+                        if(idle)
+                        {
+                            THREADPOOL_TRACE(UNPARK, nullptr, 0u);
+
+                            idle = false;
+                        }
+
+                        m_running.store(true, std::memory_order_relaxed);
+
                         runTask(task);
+
+                        m_running.store(false, std::memory_order_relaxed);
                     }
-                    else if(popFromOtherWorker(task))
+                    else if(!active)
                     {
-                        runTask(task);
+                        // switched off by setActiveWorkers, the active workers steal whatever is left in its queue;
+                        // its shard is still served, a millisecond late at worst
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
                     }
                     else
                     {
+                        if(!idle)
+                        {
+                            THREADPOOL_TRACE(PARK, nullptr, 0u);
+
+                            idle = true;
+                        }
+
                         std::this_thread::yield();
                     }
 
@@ -214,18 +538,32 @@ public:
                 m_done = true;
             }
 
+            void join()
+            {
+                if(m_thread->joinable())
+                {
+                    m_thread->join();
+                }
+            }
+
             bool busy()
             {
                 return m_busy;
             }
 
+            // queued tasks plus the running one, approximate
+            size_t load() const
+            {
+                return m_tasks->approximateSize() + (m_running.load(std::memory_order_relaxed) ? 1u : 0u);
+            }
+
             template<typename F> ThreadPool::AsyncResult<F> addTask(F&& func)
             {
                 FunctionWrapper::Ptr wrappedTask;
                 
                 auto result = ThreadPool::wrapTask(func, wrappedTask);
 
-                m_tasks->pushFront(std::move(wrappedTask));
+                addTask(std::move(wrappedTask));
 
                 return result;
             }
@@ -236,26 +574,76 @@ public:
                 
                 auto result = ThreadPool::wrapTask(func, wrappedTask);
 
-                tryResult = m_tasks->tryPushFront(std::move(wrappedTask));
+                tryResult = tryAddTask(std::move(wrappedTask));
 
                 return result;
             }
 
             void addTask(FunctionWrapper::Ptr&& wrappedTask)
             {
+                onEnqueue(wrappedTask);
+
                 m_tasks->pushFront(std::move(wrappedTask));
             }
 
             bool tryAddTask(FunctionWrapper::Ptr&& wrappedTask)
             {
+                onEnqueue(wrappedTask);
+
                 return m_tasks->tryPushFront(std::move(wrappedTask));
             }
 
+            // empty with tracing, histograms and recording all compiled out
+            static void onEnqueue([[maybe_unused]] FunctionWrapper::Ptr& wrappedTask)
+            {
+#if THREADPOOL_HISTOGRAMS
+                if(wrappedTask->m_enqueueTime == 0u)
+                {
+                    wrappedTask->m_enqueueTime = ThreadPool::now();
+                }
+#endif
+
+#if THREADPOOL_RECORDING
+                WorkloadRecorder::TaskRecord& record = wrappedTask->m_record;
+
+                if(record.id == 0u)
+                {
+                    record.id = WorkloadRecorder::nextTaskId();
+
+                    record.submitNs = WorkloadRecorder::now();
+
+                    record.submitThread = WorkloadRecorder::threadIndex();
+
+                    if(record.dependency == WorkloadRecorder::Dependency::NONE)
+                    {
+                        record.parent = WorkloadRecorder::runningTask();
+
+                        record.dependency = record.parent != 0u ? WorkloadRecorder::Dependency::SPAWNED : WorkloadRecorder::Dependency::NONE;
+                    }
+                }
+#endif
+
+#if THREADPOOL_TRACING
+                if(wrappedTask->m_traceId == 0u)
+                {
+                    wrappedTask->m_traceId = TaskTracer::nextTaskId();
+
+                    TaskTracer::record(TaskTracer::EventType::ENQUEUE, wrappedTask->m_info.name, wrappedTask->m_traceId);
+                }
+#endif
+            }
+
             ~Worker()
             {
                 m_done = true;
 
-                m_thread->join();
+                join();
+
+                // ~ThreadPool joins every thread before freeing the first worker, no producer touches the mesh now
+                for(uint32_t producer = 0u; producer < m_workerCount; ++producer)
+                {
+                    delete m_mailboxes[producer].load();
+                }
             }
 
             friend class ThreadPool;
@@ -273,6 +661,10 @@ public:
 
             std::mutex m_mut;
 
+#if THREADPOOL_RECORDING
+            uint32_t m_recordId = WorkloadRecorder::nextBarrierId();
+#endif
+
         public:
 
             Barrier() = default;
@@ -287,14 +679,21 @@ public:
                 }
             }
 
-            void increment()
+#if THREADPOOL_RECORDING
+            uint32_t recordId() const
+            {
+                return m_recordId;
+            }
+#endif
+
+            void increment(uint32_t count = 1u)
             {
                 bool toDestroy = false;
 
                 {
                     std::lock_guard<std::mutex> lk{m_mut};
 
-                    ++m_currentCount;
+                    m_currentCount += count;
 
                     toDestroy = m_currentCount == m_requiredCount;
                 }
@@ -318,24 +717,176 @@ private:
 
     std::atomic<uint32_t> m_workerID;
 
+    std::atomic<PlacementPolicy> m_placementPolicy{PlacementPolicy::ROUND_ROBIN};
+
+    std::atomic<ContinuationPolicy> m_continuationPolicy{ContinuationPolicy::INLINE};
+
+    // tasks sitting in worker queues, running ones excluded
+    std::atomic<size_t> m_queuedTasks{0u};
+
+    // 0 means unbounded
+    std::atomic<size_t> m_capacity{0u};
+
+    std::mutex m_capacityMut;
+
+    std::condition_variable m_capacityCv;
+
+    std::atomic<uint32_t> m_waitingProducers{0u};
+
+    // workers with a lower id take new tasks, the rest sleep
+    std::atomic<uint32_t> m_activeWorkers{0u};
+
+    std::mutex m_throttleMut;
+
+    std::optional<CpuQuota::ThrottleStats> m_lastThrottleStats;
+
+    std::atomic<bool> m_throttleAdaptation{false};
+
+    // after everything the worker threads touch, so that state outlives them should the workers ever be
+    // destroyed by the member destructors rather than ~ThreadPool
     std::vector<std::unique_ptr<Worker>> m_workers;
 
+    size_t m_arenaSize = WorkerArena::DEFAULT_SIZE;
+
+    inline static thread_local Worker* s_currentWorker = nullptr;
+
+    // first queue executeAsync tries, according to the placement policy
+    uint32_t pickWorker();
+
+    // places an already counted task
+    void enqueue(FunctionWrapper::Ptr&& wrappedTask);
+
+    // claims a queue slot if one is free
+    bool tryReserve();
+
+    void reserve();
+
+    bool reserveFor(std::chrono::nanoseconds timeout);
+
+    void onDequeue();
+
+    // inputs below these sizes are handled by the sequential std algorithm
+    static constexpr size_t SORT_SEQUENTIAL_CUTOFF = 1u << 15u;
+
+    static constexpr size_t SCAN_SEQUENTIAL_CUTOFF = 1u << 16u;
+
+    // tasks per worker the bulk algorithms aim for, a little slack for uneven blocks
+    static constexpr uint32_t BULK_TASKS_PER_WORKER = 4u;
+
+    // number of blocks to split n elements into, 1 means sequential
+    uint32_t bulkBlockCount(size_t n, size_t cutoff) const;
+
+#if THREADPOOL_HISTOGRAMS
+    std::mutex m_classNamesMut;
+
+    std::unordered_map<uint32_t, std::string> m_classNames;
+#endif
+
 public:
 
-    ThreadPool() = default;
+    // one worker per CPU the process may use, see CpuQuota
+    ThreadPool();
 
-    ThreadPool(uint32_t numThreads);
+    // arenaSize is the per-worker scratch block, larger requests overflow to the default heap
+    ThreadPool(uint32_t numThreads, size_t arenaSize = WorkerArena::DEFAULT_SIZE);
 
     template<typename F> AsyncResult<F> executeAsync(F&& func);
 
+    template<typename F> AsyncResult<F> executeAsync(F&& func, const TaskInfo& info);
+
     void executeAsync(FunctionWrapper::Ptr&& wrappedTask);
 
+    // like executeAsync but returns a Future, which whenAll / whenAny can combine without blocking a thread
+    template<typename F> FutureResult<F> executeFuture(F&& func);
+
+    // Sharded execution: every task of a shard key runs on the same worker, in submission order per submitting
+    // thread, and is never stolen, so per-key data stays in that worker's cache. Workers hand shard tasks to
+    // each other through a mesh of single-producer single-consumer mailboxes, other threads through a locked
+    // inbox per worker. A worker serves its shard before its regular queue; plain executeAsync tasks keep
+    // being balanced by stealing around it. Continuations of shard tasks follow the continuation policy and
+    // are not pinned. Shard tasks that have not run by the time the pool is destroyed are dropped.
+    template<typename F> AsyncResult<F> executeOn(uint64_t shardKey, F&& func);
+
+    void executeOn(uint64_t shardKey, FunctionWrapper::Ptr&& wrappedTask);
+
+    // the worker running the tasks of shardKey, fixed for the lifetime of the pool
+    uint32_t shardOf(uint64_t shardKey) const;
+
+    // slots per (producer, owner) mailbox, a producer keeps whatever does not fit until the owner catches up
+    static constexpr size_t SHARD_MAILBOX_CAPACITY = 256u;
+
+    // Bounded submission. executeAsync, continuations and barriers ignore the capacity so tasks spawning
+    // tasks can never deadlock, but their tasks count towards it. Blocking submits must not be made from
+    // inside pool tasks.
+    void setCapacity(size_t capacity);
+
+    size_t getCapacity() const;
+
+    size_t queuedTasks() const;
+
+    // fails fast when the pool is full, the callable is left untouched then
+    template<typename F> std::optional<AsyncResult<F>> trySubmit(F&& func);
+
+    bool trySubmit(FunctionWrapper::Ptr&& wrappedTask);
+
+    // parks the caller until a slot frees up
+    template<typename F> AsyncResult<F> submit(F&& func);
+
+    void submit(FunctionWrapper::Ptr&& wrappedTask);
+
+    template<typename F, typename Rep, typename Period> std::optional<AsyncResult<F>> submitFor(F&& func, const std::chrono::duration<Rep, Period>& timeout);
+
+    template<typename Rep, typename Period> bool submitFor(FunctionWrapper::Ptr&& wrappedTask, const std::chrono::duration<Rep, Period>& timeout);
+
+    // share of throttled CFS periods above which a sample counts as oversubscribed
+    static constexpr double THROTTLE_THRESHOLD = 0.05;
+
+    // Samples the cgroup throttling counters since the previous call, meant to be polled every second or so.
+    // With adaptation on, a throttled sample takes one worker out of rotation and a clean one brings one back.
+    ThrottleReport checkThrottling();
+
+    void setThrottleAdaptation(bool enabled);
+
+    // caps the workers that take new tasks, between 1 and the thread count
+    void setActiveWorkers(uint32_t count);
+
+    uint32_t activeWorkers() const;
+
+    uint32_t threadCount() const;
+
+    void setPlacementPolicy(PlacementPolicy policy);
+
+    PlacementPolicy getPlacementPolicy() const;
+
+    // tasks of one chain a worker runs back to back under ContinuationPolicy::INLINE, the first one included
+    static constexpr uint32_t MAX_INLINE_CONTINUATIONS = 16u;
+
+    void setContinuationPolicy(ContinuationPolicy policy);
+
+    ContinuationPolicy getContinuationPolicy() const;
+
     template<typename F> AsyncResultAndFuncWrapper<F> chainTask(F&& func, FunctionWrapper::Ptr& inoutPreviousTask);
 
     template<typename F> AsyncResult<F> addTasksWithBarrier(std::vector<FunctionWrapper::Ptr>&& tasks, F&& func);
 
     void addTasksWithBarrier(std::vector<FunctionWrapper::Ptr>&& tasks, FunctionWrapper::Ptr&& onComplete);
 
+    // Blocking bulk algorithms, split into a few tasks per worker. Called from inside a pool task they run
+    // sequentially, a worker must not wait on its own pool.
+
+    // runs body(i) for every i in [0, count) as count tasks and returns once all of them finished
+    template<typename F> void parallelFor(uint32_t count, F&& body);
+
+    // samplesort: sampled splitters, per-block bucket counts, a scatter into a buffer and a std::sort per
+    // bucket. Not stable, the value type must be default constructible.
+    template<typename RandomIt, typename Compare = std::less<>> void parallelSort(RandomIt first, RandomIt last, Compare comp = Compare{});
+
+    // two-pass blocked scans: block reductions, a sequential scan over the block totals, then every block
+    // scans again from its carry. op must be associative, in-place (dFirst == first) is fine.
+    template<typename RandomIt, typename RandomOutputIt, typename BinaryOp = std::plus<>> RandomOutputIt parallelInclusiveScan(RandomIt first, RandomIt last, RandomOutputIt dFirst, BinaryOp op = BinaryOp{});
+
+    template<typename RandomIt, typename RandomOutputIt, typename T, typename BinaryOp = std::plus<>> RandomOutputIt parallelExclusiveScan(RandomIt first, RandomIt last, RandomOutputIt dFirst, T init, BinaryOp op = BinaryOp{});
+
     void wait();
 
     void resume();
@@ -344,8 +895,37 @@ public:
 
     template<typename F> static ThreadPool::AsyncResult<F> wrapTask(F&& func, FunctionWrapper::Ptr& outWrappedTask);
 
+    static uint64_t now();
+
+    // the worker running the calling task, must only be called from inside a pool task
+    static Worker& currentWorker();
+
+    static bool isWorkerThread();
+
+    // the current worker's arena inside a pool task, the default resource anywhere else
+    static std::pmr::memory_resource* scratchResource();
+
+#if THREADPOOL_HISTOGRAMS
+    // time from enqueue to task start, merged over all workers
+    LatencyHistogram queueWaitHistogram(uint32_t taskClass);
+
+    // task run time, merged over all workers
+    LatencyHistogram executionHistogram(uint32_t taskClass);
+
+    void setTaskClassName(uint32_t taskClass, const std::string& name);
+
+    void resetLatencyStats();
+
+    // one line per (class, metric): count, p50, p99, p99.9 and max in nanoseconds
+    bool dumpLatencyStats(const std::string& path);
+#endif
+
+    // stops and joins every worker; tasks still queued are destroyed without running, shard tasks waiting in
+    // a mailbox, an inbox or a sender's backlog included, and their futures report broken_promise
     ~ThreadPool();
 
 };
 
-#include "ThreadPool.inl"
\ No newline at end of file
+#include "ThreadPool.inl"
+#include "ParallelAlgorithms.inl"
+#include "Future.hpp"
\ No newline at end of file
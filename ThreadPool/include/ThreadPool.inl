@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdio>
+#include <fstream>
+
 template<typename F> ThreadPool::AsyncResult<F> ThreadPool::wrapTask(F&& func, ThreadPool::FunctionWrapper::Ptr& outWrappedTask)
 {
     typedef typename std::result_of<F()>::type FunctionType;
@@ -17,25 +20,95 @@ template<typename F> ThreadPool::AsyncResult<F> ThreadPool::wrapTask(F&& func, T
 
 template<typename F> ThreadPool::AsyncResult<F> ThreadPool::executeAsync(F&& func)
 {
-    uint32_t workerID = m_workerID.load();
+    FunctionWrapper::Ptr wrappedTask;
+
+    // wrapped once up front, a failed tryAddTask must not leave a moved-from func for the next attempt
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    executeAsync(std::move(wrappedTask));
+
+    return result;
+}
+
+template<typename F> ThreadPool::AsyncResult<F> ThreadPool::executeAsync(F&& func, const TaskInfo& info)
+{
+    FunctionWrapper::Ptr wrappedTask;
+
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    wrappedTask->info() = info;
 
-    workerID = (workerID + 1) % m_workers.size();
+    executeAsync(std::move(wrappedTask));
 
-    for(uint32_t i = 0; i < m_workers.size(); ++i)
+    return result;
+}
+
+template<typename F> std::optional<ThreadPool::AsyncResult<F>> ThreadPool::trySubmit(F&& func)
+{
+    if(!tryReserve())
     {
-        uint32_t id = (workerID + i) % m_workers.size();
-        
-        bool result = false;
+        return std::nullopt;
+    }
 
-        auto fut = m_workers[id]->tryAddTask(std::move(func), result);
+    FunctionWrapper::Ptr wrappedTask;
 
-        if(result)
-        {
-            return fut;
-        }
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    enqueue(std::move(wrappedTask));
+
+    return result;
+}
+
+template<typename F> ThreadPool::AsyncResult<F> ThreadPool::submit(F&& func)
+{
+    reserve();
+
+    FunctionWrapper::Ptr wrappedTask;
+
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    enqueue(std::move(wrappedTask));
+
+    return result;
+}
+
+template<typename F, typename Rep, typename Period> std::optional<ThreadPool::AsyncResult<F>> ThreadPool::submitFor(F&& func, const std::chrono::duration<Rep, Period>& timeout)
+{
+    if(!reserveFor(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)))
+    {
+        return std::nullopt;
     }
 
-    return m_workers[workerID]->addTask(std::move(func));
+    FunctionWrapper::Ptr wrappedTask;
+
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    enqueue(std::move(wrappedTask));
+
+    return result;
+}
+
+template<typename Rep, typename Period> bool ThreadPool::submitFor(FunctionWrapper::Ptr&& wrappedTask, const std::chrono::duration<Rep, Period>& timeout)
+{
+    if(!reserveFor(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)))
+    {
+        return false;
+    }
+
+    enqueue(std::move(wrappedTask));
+
+    return true;
+}
+
+template<typename F> ThreadPool::AsyncResult<F> ThreadPool::executeOn(uint64_t shardKey, F&& func)
+{
+    FunctionWrapper::Ptr wrappedTask;
+
+    auto result = ThreadPool::wrapTask(func, wrappedTask);
+
+    executeOn(shardKey, std::move(wrappedTask));
+
+    return result;
 }
 
 template<typename F> ThreadPool::AsyncResultAndFuncWrapper<F> ThreadPool::chainTask(F&& func, FunctionWrapper::Ptr& inoutPreviousTask)
@@ -51,17 +124,158 @@ template<typename F> ThreadPool::AsyncResultAndFuncWrapper<F> ThreadPool::chainT
 
 void ThreadPool::executeAsync(FunctionWrapper::Ptr&& wrappedTask)
 {
-    uint32_t workerID = m_workerID.load();
+    m_queuedTasks.fetch_add(1u);
+
+    enqueue(std::move(wrappedTask));
+}
+
+void ThreadPool::executeOn(uint64_t shardKey, FunctionWrapper::Ptr&& wrappedTask)
+{
+    m_queuedTasks.fetch_add(1u);
+
+    Worker::onEnqueue(wrappedTask);
+
+    Worker& owner = *m_workers[shardOf(shardKey)];
+
+    // only a worker of this pool owns a row of the mailbox mesh
+    if(s_currentWorker != nullptr && s_currentWorker->m_poolPtr == this)
+    {
+        s_currentWorker->sendToShard(owner, std::move(wrappedTask));
+    }
+    else
+    {
+        owner.m_shardInbox->pushFront(std::move(wrappedTask));
+    }
+}
+
+uint32_t ThreadPool::shardOf(uint64_t shardKey) const
+{
+    // splitmix64 finalizer, sequential keys spread over all workers
+    shardKey = (shardKey ^ (shardKey >> 30u)) * 0xbf58476d1ce4e5b9ull;
+    shardKey = (shardKey ^ (shardKey >> 27u)) * 0x94d049bb133111ebull;
+    shardKey ^= shardKey >> 31u;
+
+    return static_cast<uint32_t>(shardKey % m_workers.size());
+}
+
+bool ThreadPool::trySubmit(FunctionWrapper::Ptr&& wrappedTask)
+{
+    if(!tryReserve())
+    {
+        return false;
+    }
+
+    enqueue(std::move(wrappedTask));
+
+    return true;
+}
+
+void ThreadPool::submit(FunctionWrapper::Ptr&& wrappedTask)
+{
+    reserve();
+
+    enqueue(std::move(wrappedTask));
+}
+
+void ThreadPool::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+
+    std::lock_guard<std::mutex> lk{m_capacityMut};
+
+    m_capacityCv.notify_all();
+}
+
+size_t ThreadPool::getCapacity() const
+{
+    return m_capacity;
+}
+
+size_t ThreadPool::queuedTasks() const
+{
+    return m_queuedTasks;
+}
+
+bool ThreadPool::tryReserve()
+{
+    size_t queued = m_queuedTasks.load();
 
-    m_workerID = (workerID + 1) % m_workers.size();
+    do
+    {
+        const size_t capacity = m_capacity.load();
+
+        if(capacity != 0u && queued >= capacity)
+        {
+            return false;
+        }
+    }
+    while(!m_queuedTasks.compare_exchange_weak(queued, queued + 1u));
+
+    return true;
+}
+
+void ThreadPool::reserve()
+{
+    if(tryReserve())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk{m_capacityMut};
+
+    // registered before the predicate is checked, so a worker freeing a slot in between still notifies
+    ++m_waitingProducers;
+
+    m_capacityCv.wait(lk, [this]() -> bool { return tryReserve(); });
+
+    --m_waitingProducers;
+}
+
+bool ThreadPool::reserveFor(std::chrono::nanoseconds timeout)
+{
+    if(tryReserve())
+    {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lk{m_capacityMut};
+
+    ++m_waitingProducers;
+
+    const bool reserved = m_capacityCv.wait_for(lk, timeout, [this]() -> bool { return tryReserve(); });
+
+    --m_waitingProducers;
+
+    return reserved;
+}
+
+void ThreadPool::onDequeue()
+{
+    const size_t queued = m_queuedTasks.fetch_sub(1u) - 1u;
+
+    // parked producers are woken once the queues are half drained, so they refill in bursts instead of
+    // trading a context switch for every task
+    if(m_waitingProducers.load() != 0u && queued <= m_capacity.load() / 2u)
+    {
+        std::lock_guard<std::mutex> lk{m_capacityMut};
+
+        m_capacityCv.notify_one();
+    }
+}
+
+void ThreadPool::enqueue(FunctionWrapper::Ptr&& wrappedTask)
+{
+    const uint32_t workerID = pickWorker();
+
+    const uint32_t activeWorkers = m_activeWorkers.load(std::memory_order_relaxed);
 
     uint32_t K = 2;
 
     uint32_t i = 0u;
 
-    for(; i < m_workers.size() * K; ++i)
+    for(; i < activeWorkers * K; ++i)
     {
-        uint32_t id = (workerID + i) % m_workers.size();
+        uint32_t id = (workerID + i) % activeWorkers;
         
         bool result = false;
 
@@ -76,6 +290,99 @@ void ThreadPool::executeAsync(FunctionWrapper::Ptr&& wrappedTask)
     m_workers[workerID]->addTask(std::move(wrappedTask));
 }
 
+ThreadPool::ThrottleReport ThreadPool::checkThrottling()
+{
+    ThrottleReport report;
+
+    std::lock_guard<std::mutex> lk{m_throttleMut};
+
+    std::optional<CpuQuota::ThrottleStats> stats = CpuQuota::throttleStats();
+
+    if(stats && m_lastThrottleStats && stats->periods > m_lastThrottleStats->periods)
+    {
+        report.throttledFraction = static_cast<double>(stats->throttledPeriods - m_lastThrottleStats->throttledPeriods) / static_cast<double>(stats->periods - m_lastThrottleStats->periods);
+
+        report.throttledNs = stats->throttledNs - m_lastThrottleStats->throttledNs;
+
+        report.oversubscribed = report.throttledFraction > THROTTLE_THRESHOLD;
+
+        if(m_throttleAdaptation.load())
+        {
+            const uint32_t active = m_activeWorkers.load();
+
+            setActiveWorkers(report.oversubscribed ? active - 1u : active + 1u);
+        }
+    }
+
+    m_lastThrottleStats = stats;
+
+    report.activeWorkers = m_activeWorkers.load();
+
+    return report;
+}
+
+void ThreadPool::setThrottleAdaptation(bool enabled)
+{
+    m_throttleAdaptation = enabled;
+}
+
+void ThreadPool::setActiveWorkers(uint32_t count)
+{
+    m_activeWorkers = std::clamp<uint32_t>(count, 1u, static_cast<uint32_t>(m_workers.size()));
+}
+
+uint32_t ThreadPool::activeWorkers() const
+{
+    return m_activeWorkers;
+}
+
+uint32_t ThreadPool::threadCount() const
+{
+    return static_cast<uint32_t>(m_workers.size());
+}
+
+void ThreadPool::setPlacementPolicy(PlacementPolicy policy)
+{
+    m_placementPolicy.store(policy, std::memory_order_relaxed);
+}
+
+ThreadPool::PlacementPolicy ThreadPool::getPlacementPolicy() const
+{
+    return m_placementPolicy.load(std::memory_order_relaxed);
+}
+
+void ThreadPool::setContinuationPolicy(ContinuationPolicy policy)
+{
+    m_continuationPolicy.store(policy, std::memory_order_relaxed);
+}
+
+ThreadPool::ContinuationPolicy ThreadPool::getContinuationPolicy() const
+{
+    return m_continuationPolicy.load(std::memory_order_relaxed);
+}
+
+uint32_t ThreadPool::pickWorker()
+{
+    const uint32_t workerCount = m_activeWorkers.load(std::memory_order_relaxed);
+
+    if(m_placementPolicy.load(std::memory_order_relaxed) == PlacementPolicy::ROUND_ROBIN || workerCount < 2u)
+    {
+        return m_workerID.fetch_add(1u, std::memory_order_relaxed) % workerCount;
+    }
+
+    // xorshift per producer thread, the samples only need to be cheap and uncorrelated between producers
+    thread_local uint32_t state = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+
+    state ^= state << 13u;
+    state ^= state >> 17u;
+    state ^= state << 5u;
+
+    const uint32_t first = state % workerCount;
+    const uint32_t second = (first + 1u + (state >> 16u) % (workerCount - 1u)) % workerCount;
+
+    return m_workers[second]->load() < m_workers[first]->load() ? second : first;
+}
+
 void ThreadPool::wait()
 {
     m_paused = true;
@@ -83,7 +390,8 @@ void ThreadPool::wait()
 
 void ThreadPool::resume()
 {
-    while(workersBusy())
+    // waits for a pause to settle; a running pool's workers are busy on every pass, even idle ones
+    while(m_paused && workersBusy())
     {
         std::this_thread::yield();
     }
@@ -93,13 +401,25 @@ void ThreadPool::resume()
     m_cv.notify_all();
 }
 
-ThreadPool::ThreadPool(uint32_t numThreads) : m_done{false}, m_paused{true}, m_workerID{0u}
+ThreadPool::ThreadPool() : ThreadPool{CpuQuota::availableCpus()}
 {
-    DEBUG_ASSERT(numThreads <= std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(uint32_t numThreads, size_t arenaSize) : m_paused{true}, m_done{false}, m_workerID{0u}, m_activeWorkers{numThreads}, m_arenaSize{arenaSize}
+{
+    ALWAYS_ASSERT(numThreads != 0u && "<-- assert a pool needs at least one worker");
+
+    // oversubscribing is allowed, but inside a container it usually means throttling; said once per process,
+    // programs creating many pools would repeat it otherwise
+    static std::atomic<bool> s_oversubscriptionLogged{false};
+
+    ALWAYS_LOG(numThreads <= CpuQuota::availableCpus() || s_oversubscriptionLogged.exchange(true), "ThreadPool has more workers than the CPUs available to the process");
+
+    m_lastThrottleStats = CpuQuota::throttleStats();
 
     for(uint32_t workerIndex = 0; workerIndex < numThreads; ++workerIndex)
     {
-        m_workers.push_back(std::unique_ptr<Worker>{new Worker{workerIndex, this, &Worker::run}});
+        m_workers.push_back(std::unique_ptr<Worker>{new Worker{workerIndex, numThreads, this, &Worker::run}});
     }
 }
 
@@ -135,15 +455,27 @@ void ThreadPool::addTasksWithBarrier(std::vector<FunctionWrapper::Ptr>&& tasks,
 
 ThreadPool::~ThreadPool()
 {
+    // every thread stops before the first worker is freed, until then the others may still steal from its queue
     for(auto& worker : m_workers)
     {
-        worker->m_done = true;
+        worker->finishWork();
     }
 
-    while(workersBusy())
+    // workers of a paused pool are parked on m_cv
     {
-        std::this_thread::yield();
+        std::lock_guard<std::mutex> lk{m_mut};
+
+        m_paused = false;
     }
+
+    m_cv.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        worker->join();
+    }
+
+    m_workers.clear();
 }
 
 bool ThreadPool::workersBusy()
@@ -157,4 +489,133 @@ bool ThreadPool::workersBusy()
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+uint64_t ThreadPool::now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+ThreadPool::Worker& ThreadPool::currentWorker()
+{
+    ALWAYS_ASSERT(s_currentWorker != nullptr && "<-- currentWorker called outside a pool task");
+
+    return *s_currentWorker;
+}
+
+bool ThreadPool::isWorkerThread()
+{
+    return s_currentWorker != nullptr;
+}
+
+std::pmr::memory_resource* ThreadPool::scratchResource()
+{
+    return s_currentWorker != nullptr ? &s_currentWorker->arena() : std::pmr::get_default_resource();
+}
+
+#if THREADPOOL_HISTOGRAMS
+
+LatencyHistogram ThreadPool::queueWaitHistogram(uint32_t taskClass)
+{
+    taskClass = std::min<uint32_t>(taskClass, THREADPOOL_MAX_TASK_CLASSES - 1u);
+
+    LatencyHistogram result;
+
+    for(auto& pWorker : m_workers)
+    {
+        result.merge(pWorker->m_latency->queueWait[taskClass]);
+    }
+
+    return result;
+}
+
+LatencyHistogram ThreadPool::executionHistogram(uint32_t taskClass)
+{
+    taskClass = std::min<uint32_t>(taskClass, THREADPOOL_MAX_TASK_CLASSES - 1u);
+
+    LatencyHistogram result;
+
+    for(auto& pWorker : m_workers)
+    {
+        result.merge(pWorker->m_latency->execution[taskClass]);
+    }
+
+    return result;
+}
+
+void ThreadPool::setTaskClassName(uint32_t taskClass, const std::string& name)
+{
+    std::lock_guard<std::mutex> lk{m_classNamesMut};
+
+    m_classNames[taskClass] = name;
+}
+
+void ThreadPool::resetLatencyStats()
+{
+    for(auto& pWorker : m_workers)
+    {
+        for(uint32_t taskClass = 0u; taskClass < THREADPOOL_MAX_TASK_CLASSES; ++taskClass)
+        {
+            pWorker->m_latency->queueWait[taskClass].reset();
+
+            pWorker->m_latency->execution[taskClass].reset();
+        }
+    }
+}
+
+bool ThreadPool::dumpLatencyStats(const std::string& path)
+{
+    // written to a temporary file and renamed, so a scraper never reads a half-written dump
+    const std::string tmpPath = path + ".tmp";
+
+    {
+        std::ofstream out{tmpPath};
+
+        if(!out)
+        {
+            return false;
+        }
+
+        out << "# class name metric count p50_ns p99_ns p999_ns max_ns\n";
+
+        for(uint32_t taskClass = 0u; taskClass < THREADPOOL_MAX_TASK_CLASSES; ++taskClass)
+        {
+            std::string name;
+
+            {
+                std::lock_guard<std::mutex> lk{m_classNamesMut};
+
+                auto it = m_classNames.find(taskClass);
+
+                name = it != m_classNames.end() ? it->second : "class" + std::to_string(taskClass);
+            }
+
+            const std::pair<const char*, LatencyHistogram> metrics[] = 
+            {
+                {"queue_wait", queueWaitHistogram(taskClass)},
+                {"execution", executionHistogram(taskClass)}
+            };
+
+            for(const auto& metric : metrics)
+            {
+                if(metric.second.count() == 0u)
+                {
+                    continue;
+                }
+
+                out << taskClass << ' ' << name << ' ' << metric.first << ' ' << metric.second.count() << ' '
+                    << metric.second.percentile(50.) << ' ' << metric.second.percentile(99.) << ' '
+                    << metric.second.percentile(99.9) << ' ' << metric.second.max() << '\n';
+            }
+        }
+
+        if(!out)
+        {
+            return false;
+        }
+    }
+
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Monotonic scratch memory owned by one worker. Allocations are pointer bumps in a single block that is
+// touched (and allocated) by the worker thread only; once the block is exhausted requests go to a
+// monotonic resource over the upstream one. deallocate is a no-op, everything is dropped at once by reset(),
+// which the worker calls after every top-level task, so nothing allocated here may outlive the task.
+class WorkerArena : public std::pmr::memory_resource
+{
+    public:
+
+        static constexpr size_t DEFAULT_SIZE = 256u * 1024u;
+
+        // the block is cache line aligned
+        static constexpr size_t BLOCK_ALIGNMENT = 64u;
+
+        explicit WorkerArena(size_t size = DEFAULT_SIZE, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+        WorkerArena(const WorkerArena& other) = delete;
+
+        WorkerArena& operator=(const WorkerArena& other) = delete;
+
+        ~WorkerArena() override;
+
+        // drops everything allocated since the last reset, the block itself is kept
+        void reset();
+
+        size_t size() const;
+
+        // bytes handed out from the block since the last reset
+        size_t used() const;
+
+        // bytes served by the overflow resource since the last reset
+        size_t overflowBytes() const;
+
+    private:
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::pmr::memory_resource* m_upstream;
+
+        std::byte* m_block = nullptr;
+
+        size_t m_size;
+
+        size_t m_offset = 0u;
+
+        std::pmr::monotonic_buffer_resource m_overflow;
+
+        size_t m_overflowBytes = 0u;
+};
+
+#include "WorkerArena.inl"
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+inline WorkerArena::WorkerArena(size_t size, std::pmr::memory_resource* upstream) : m_upstream{upstream}, m_size{size}, m_overflow{upstream}
+{
+}
+
+inline WorkerArena::~WorkerArena()
+{
+    if(m_block != nullptr)
+    {
+        m_upstream->deallocate(m_block, m_size, BLOCK_ALIGNMENT);
+    }
+}
+
+inline void WorkerArena::reset()
+{
+    m_offset = 0u;
+
+    if(m_overflowBytes != 0u)
+    {
+        m_overflow.release();
+
+        m_overflowBytes = 0u;
+    }
+}
+
+inline size_t WorkerArena::size() const
+{
+    return m_size;
+}
+
+inline size_t WorkerArena::used() const
+{
+    return m_offset;
+}
+
+inline size_t WorkerArena::overflowBytes() const
+{
+    return m_overflowBytes;
+}
+
+inline void* WorkerArena::do_allocate(size_t bytes, size_t alignment)
+{
+    // allocated on first use, so the pages are first touched by the thread that owns them
+    if(m_block == nullptr && m_size != 0u)
+    {
+        m_block = static_cast<std::byte*>(m_upstream->allocate(m_size, BLOCK_ALIGNMENT));
+    }
+
+    const size_t offset = (m_offset + alignment - 1u) & ~(alignment - 1u);
+
+    // offsets are aligned relative to the block, which only holds up to the block's own alignment
+    if(m_block != nullptr && alignment <= BLOCK_ALIGNMENT && offset <= m_size && bytes <= m_size - offset)
+    {
+        m_offset = offset + bytes;
+
+        return m_block + offset;
+    }
+
+    m_overflowBytes += bytes;
+
+    return m_overflow.allocate(bytes, alignment);
+}
+
+// monotonic, everything goes at the next reset
+inline void WorkerArena::do_deallocate(void* /*ptr*/, size_t /*bytes*/, size_t /*alignment*/)
+{
+}
+
+inline bool WorkerArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
\ No newline at end of file
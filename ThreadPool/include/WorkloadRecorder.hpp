@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Workload recording. Compiled in only when THREADPOOL_RECORDING is defined to a non-zero value. Every task the
+// pool runs leaves one fixed-size record: when and from which thread it was submitted, what it depends on and
+// how long it ran. benchmarks/workload_replay re-issues the same shape of work against any pool configuration.
+#ifndef THREADPOOL_RECORDING
+    #define THREADPOOL_RECORDING 0
+#endif
+
+class WorkloadRecorder
+{
+    public:
+
+        enum class Dependency : uint8_t
+        {
+            // submitted from outside any task
+            NONE,
+            // submitted by the running task parent
+            SPAWNED,
+            // continuation of parent, set up through chainTask
+            CHAINED
+        };
+
+        // written to the file as is, native byte order
+        struct TaskRecord
+        {
+            uint64_t submitNs = 0u;
+
+            uint64_t startNs = 0u;
+
+            uint64_t runNs = 0u;
+
+            uint32_t id = 0u;
+
+            // 0 when dependency is NONE
+            uint32_t parent = 0u;
+
+            // 0 when the task counts towards no barrier, the tasks sharing an id make up one barrier
+            uint32_t barrier = 0u;
+
+            uint16_t submitThread = 0u;
+
+            uint16_t worker = 0u;
+
+            Dependency dependency = Dependency::NONE;
+
+            uint8_t reserved[7] = {};
+        };
+
+        static_assert(sizeof(TaskRecord) == 48u, "TaskRecord is a file format");
+
+        static constexpr char MAGIC[4] = {'T', 'P', 'W', 'L'};
+
+        static constexpr uint32_t VERSION = 1u;
+
+        static void record(const TaskRecord& taskRecord);
+
+        static uint32_t nextTaskId();
+
+        static uint32_t nextBarrierId();
+
+        // small per-thread index in order of first use, stands in for the submitting thread
+        static uint16_t threadIndex();
+
+        // id of the task running on the calling thread, 0 outside tasks
+        static uint32_t runningTask();
+
+        static void setRunningTask(uint32_t id);
+
+        // records of all threads sorted by submit time, timestamps relative to the first submission; call once
+        // the recorded workload finished
+        static bool dump(const std::string& path);
+
+        static bool load(const std::string& path, std::vector<TaskRecord>& outRecords);
+
+        static void clear();
+
+        static uint64_t now();
+
+    private:
+
+        struct ThreadBuffer
+        {
+            std::mutex mut;
+
+            std::vector<TaskRecord> records;
+        };
+
+        static ThreadBuffer& localBuffer();
+
+        inline static std::mutex s_registryMutex;
+
+        inline static std::vector<std::shared_ptr<ThreadBuffer>> s_buffers;
+
+        inline static std::atomic<uint32_t> s_taskId{0u};
+
+        inline static std::atomic<uint32_t> s_barrierId{0u};
+
+        inline static thread_local uint32_t s_runningTask = 0u;
+};
+
+#include "WorkloadRecorder.inl"
\ No newline at end of file
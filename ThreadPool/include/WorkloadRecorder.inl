@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+inline uint64_t WorkloadRecorder::now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline WorkloadRecorder::ThreadBuffer& WorkloadRecorder::localBuffer()
+{
+    // shared with the registry so records of finished threads survive until the dump
+    thread_local std::shared_ptr<ThreadBuffer> buffer = []() -> std::shared_ptr<ThreadBuffer>
+    {
+        std::lock_guard<std::mutex> lk{s_registryMutex};
+
+        auto result = std::make_shared<ThreadBuffer>();
+
+        s_buffers.push_back(result);
+
+        return result;
+    }();
+
+    return *buffer;
+}
+
+inline void WorkloadRecorder::record(const TaskRecord& taskRecord)
+{
+    ThreadBuffer& buffer = localBuffer();
+
+    // only ever contended by a dump
+    std::lock_guard<std::mutex> lk{buffer.mut};
+
+    buffer.records.push_back(taskRecord);
+}
+
+inline uint32_t WorkloadRecorder::nextTaskId()
+{
+    return s_taskId.fetch_add(1u, std::memory_order_relaxed) + 1u;
+}
+
+inline uint32_t WorkloadRecorder::nextBarrierId()
+{
+    return s_barrierId.fetch_add(1u, std::memory_order_relaxed) + 1u;
+}
+
+inline uint16_t WorkloadRecorder::threadIndex()
+{
+    thread_local uint16_t index = []() -> uint16_t
+    {
+        static std::atomic<uint16_t> s_nextIndex{0u};
+
+        return s_nextIndex.fetch_add(1u, std::memory_order_relaxed);
+    }();
+
+    return index;
+}
+
+inline uint32_t WorkloadRecorder::runningTask()
+{
+    return s_runningTask;
+}
+
+inline void WorkloadRecorder::setRunningTask(uint32_t id)
+{
+    s_runningTask = id;
+}
+
+inline bool WorkloadRecorder::dump(const std::string& path)
+{
+    std::vector<TaskRecord> records;
+
+    {
+        std::lock_guard<std::mutex> lk{s_registryMutex};
+
+        for(auto& buffer : s_buffers)
+        {
+            std::lock_guard<std::mutex> bufferLk{buffer->mut};
+
+            records.insert(records.end(), buffer->records.begin(), buffer->records.end());
+        }
+    }
+
+    std::sort(records.begin(), records.end(), [](const TaskRecord& lhs, const TaskRecord& rhs) -> bool { return lhs.submitNs < rhs.submitNs; });
+
+    const uint64_t origin = records.empty() ? 0u : records.front().submitNs;
+
+    for(TaskRecord& taskRecord : records)
+    {
+        taskRecord.submitNs -= origin;
+
+        taskRecord.startNs -= origin;
+    }
+
+    std::ofstream out{path, std::ios::binary};
+
+    if(!out)
+    {
+        return false;
+    }
+
+    const uint64_t count = records.size();
+
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(count * sizeof(TaskRecord)));
+
+    return static_cast<bool>(out);
+}
+
+inline bool WorkloadRecorder::load(const std::string& path, std::vector<TaskRecord>& outRecords)
+{
+    std::ifstream in{path, std::ios::binary};
+
+    char magic[sizeof(MAGIC)] = {};
+
+    uint32_t version = 0u;
+
+    uint64_t count = 0u;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    if(!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION)
+    {
+        return false;
+    }
+
+    // the header count is checked against what the file holds, a truncated or corrupt file must not size the vector
+    const std::streamoff header = in.tellg();
+
+    in.seekg(0, std::ios::end);
+
+    const std::streamoff payload = in.tellg() - header;
+
+    in.seekg(header);
+
+    if(!in || payload < 0 || count > static_cast<uint64_t>(payload) / sizeof(TaskRecord))
+    {
+        return false;
+    }
+
+    outRecords.resize(count);
+
+    in.read(reinterpret_cast<char*>(outRecords.data()), static_cast<std::streamsize>(count * sizeof(TaskRecord)));
+
+    return static_cast<bool>(in);
+}
+
+inline void WorkloadRecorder::clear()
+{
+    std::lock_guard<std::mutex> lk{s_registryMutex};
+
+    for(auto& buffer : s_buffers)
+    {
+        std::lock_guard<std::mutex> bufferLk{buffer->mut};
+
+        buffer->records.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,617 @@
+#include <ThreadPool.hpp>
+#include <MandelbrotRenderer.hpp>
+#include <DeepZoomRenderer.hpp>
+#include <StreamingRenderer.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+// Headless Mandelbrot render benchmark.
+// Usage: mandelbrot_bench [--width N] [--height N] [--iterations N] [--viewport LEFT,RIGHT,BOTTOM,TOP]
+//                         [--batching none|batch|tiled|subdivision] [--tile-size N] [--threading none|pool] [--kernel scalar|vector]
+//                         [--isa scalar|sse2|avx2|avx512] [--shortcuts on|off] [--verify on|off] [--coalesce on|off]
+//                         [--deep-zoom on|off] [--center RE,IM] [--span WIDTH]
+//                         [--stream PATH] [--in-flight N]
+//                         [--threads N] [--capacity N] [--repeat N] [--warmup N] [--ppm PATH]
+// --verify renders once more with shortcuts off and without perturbation and reports how many pixels differ. With
+// --kernel vector it also renders with every isa the CPU supports and exits with 1 if any checksum differs.
+// --center takes decimal strings of any length and together with --span replaces --viewport; --deep-zoom renders
+// tiles through DeepZoomRenderer, --batching and --kernel are ignored then.
+// --coalesce packs the per-pixel tasks of --batching none through a TaskCoalescer.
+// --stream renders row after row of tiles into a memory-mapped PPM at PATH with at most --in-flight tiles
+// outstanding instead of into memory; --batching, --deep-zoom, --verify and --ppm do not apply.
+
+using BatchingStrategy = MandelbrotRenderer::BatchingStrategy;
+using ThreadingStrategy = MandelbrotRenderer::ThreadingStrategy;
+using KernelStrategy = MandelbrotRenderer::KernelStrategy;
+
+struct BenchmarkOptions
+{
+    uint32_t width = 800u;
+    uint32_t height = 600u;
+    uint32_t iterations = 1000u;
+    uint32_t threads = CpuQuota::availableCpus();
+    uint32_t repeat = 5u;
+    uint32_t warmup = 1u;
+    uint32_t tileSize = 64u;
+
+    // pool queue bound, 0 is unbounded
+    uint32_t capacity = 0u;
+
+    ldouble left = -2.;
+    ldouble right = 2.;
+    ldouble bottom = -2.;
+    ldouble top = 2.;
+
+    BatchingStrategy batching = BatchingStrategy::ENABLE_BATCHING;
+    ThreadingStrategy threading = ThreadingStrategy::ENABLE_THREADPOOL;
+    KernelStrategy kernel = KernelStrategy::SCALAR;
+
+    MandelbrotKernel::Isa isa = MandelbrotKernel::detectIsa();
+
+    bool shortcuts = false;
+    bool verify = false;
+    bool deepZoom = false;
+    bool coalesce = false;
+
+    std::string centerReal;
+    std::string centerImaginary;
+
+    ldouble span = 0.;
+
+    std::string ppmPath;
+
+    std::string streamPath;
+
+    uint32_t tilesInFlight = 64u;
+};
+
+static const char* toString(BatchingStrategy strategy)
+{
+    switch(strategy)
+    {
+        case BatchingStrategy::DISABLE_BATCHING: return "none";
+        case BatchingStrategy::ENABLE_BATCHING: return "batch";
+        case BatchingStrategy::TILED: return "tiled";
+        case BatchingStrategy::SUBDIVISION: return "subdivision";
+    }
+
+    return "unknown";
+}
+
+static const char* toString(ThreadingStrategy strategy)
+{
+    switch(strategy)
+    {
+        case ThreadingStrategy::DISABLE_THREADPOOL: return "none";
+        case ThreadingStrategy::ENABLE_THREADPOOL: return "pool";
+    }
+
+    return "unknown";
+}
+
+static const char* toString(KernelStrategy strategy)
+{
+    switch(strategy)
+    {
+        case KernelStrategy::SCALAR: return "scalar";
+        case KernelStrategy::VECTORIZED: return "vector";
+    }
+
+    return "unknown";
+}
+
+static bool parseKernel(const std::string& name, KernelStrategy& outStrategy)
+{
+    for(KernelStrategy strategy : {KernelStrategy::SCALAR, KernelStrategy::VECTORIZED})
+    {
+        if(name == toString(strategy))
+        {
+            outStrategy = strategy;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool parseIsa(const std::string& name, MandelbrotKernel::Isa& outIsa)
+{
+    for(MandelbrotKernel::Isa isa : {MandelbrotKernel::Isa::SCALAR, MandelbrotKernel::Isa::SSE2, MandelbrotKernel::Isa::AVX2, MandelbrotKernel::Isa::AVX512})
+    {
+        if(name == MandelbrotKernel::toString(isa))
+        {
+            outIsa = isa;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool parseBatching(const std::string& name, BatchingStrategy& outStrategy)
+{
+    for(BatchingStrategy strategy : {BatchingStrategy::DISABLE_BATCHING, BatchingStrategy::ENABLE_BATCHING, BatchingStrategy::TILED, BatchingStrategy::SUBDIVISION})
+    {
+        if(name == toString(strategy))
+        {
+            outStrategy = strategy;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool parseThreading(const std::string& name, ThreadingStrategy& outStrategy)
+{
+    for(ThreadingStrategy strategy : {ThreadingStrategy::DISABLE_THREADPOOL, ThreadingStrategy::ENABLE_THREADPOOL})
+    {
+        if(name == toString(strategy))
+        {
+            outStrategy = strategy;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template<BatchingStrategy batchingStrategy>
+static void renderWithThreading(ThreadingStrategy threading, PixelBuffer& image)
+{
+    switch(threading)
+    {
+        case ThreadingStrategy::DISABLE_THREADPOOL:
+            MandelbrotRenderer::render<batchingStrategy, ThreadingStrategy::DISABLE_THREADPOOL>(image);
+            break;
+
+        case ThreadingStrategy::ENABLE_THREADPOOL:
+            MandelbrotRenderer::render<batchingStrategy, ThreadingStrategy::ENABLE_THREADPOOL>(image);
+            break;
+    }
+}
+
+static void render(BatchingStrategy batching, ThreadingStrategy threading, bool deepZoom, PixelBuffer& image)
+{
+    if(deepZoom)
+    {
+        if(threading == ThreadingStrategy::ENABLE_THREADPOOL)
+        {
+            DeepZoomRenderer::render<ThreadingStrategy::ENABLE_THREADPOOL>(image);
+        }
+        else
+        {
+            DeepZoomRenderer::render<ThreadingStrategy::DISABLE_THREADPOOL>(image);
+        }
+
+        return;
+    }
+
+    switch(batching)
+    {
+        case BatchingStrategy::DISABLE_BATCHING:
+            renderWithThreading<BatchingStrategy::DISABLE_BATCHING>(threading, image);
+            break;
+
+        case BatchingStrategy::ENABLE_BATCHING:
+            renderWithThreading<BatchingStrategy::ENABLE_BATCHING>(threading, image);
+            break;
+
+        case BatchingStrategy::TILED:
+            renderWithThreading<BatchingStrategy::TILED>(threading, image);
+            break;
+
+        case BatchingStrategy::SUBDIVISION:
+            renderWithThreading<BatchingStrategy::SUBDIVISION>(threading, image);
+            break;
+    }
+}
+
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+// FNV-1a over the pixels, lets different strategies be compared without writing images
+static uint64_t checksum(const PixelBuffer& image)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    const uint8_t* pixels = image.getPixelsPtr();
+
+    for(size_t i = 0u, size = static_cast<size_t>(image.getSize().x) * image.getSize().y * 4u; i < size; ++i)
+    {
+        hash = (hash ^ pixels[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+// same hash for a streamed PPM, read back in chunks with the opaque alpha PixelBuffer would hold
+static uint64_t checksum(const std::string& ppmPath)
+{
+    std::ifstream in{ppmPath, std::ios::binary};
+
+    std::string magic;
+    uint32_t width = 0u, height = 0u, maxValue = 0u;
+
+    in >> magic >> width >> height >> maxValue;
+    in.get();
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    std::vector<char> chunk(static_cast<size_t>(1u) << 20u);
+
+    while(in)
+    {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size() / 3u * 3u));
+
+        for(std::streamsize i = 0; i + 2 < in.gcount(); i += 3)
+        {
+            hash = (hash ^ static_cast<uint8_t>(chunk[i])) * FNV_PRIME;
+            hash = (hash ^ static_cast<uint8_t>(chunk[i + 1])) * FNV_PRIME;
+            hash = (hash ^ static_cast<uint8_t>(chunk[i + 2])) * FNV_PRIME;
+            hash = (hash ^ 255u) * FNV_PRIME;
+        }
+    }
+
+    return hash;
+}
+
+static uint64_t peakResidentKiB()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    #if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss) / 1024u;
+    #else
+        return static_cast<uint64_t>(usage.ru_maxrss);
+    #endif
+#else
+    return 0u;
+#endif
+}
+
+static bool parseArguments(int argc, char** argv, BenchmarkOptions& options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if(i + 1 >= argc)
+        {
+            return false;
+        }
+
+        const std::string value = argv[++i];
+
+        if(arg == "--width")
+        {
+            options.width = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--height")
+        {
+            options.height = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--iterations")
+        {
+            options.iterations = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--threads")
+        {
+            options.threads = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--capacity")
+        {
+            options.capacity = std::max(0, std::atoi(value.c_str()));
+        }
+        else if(arg == "--repeat")
+        {
+            options.repeat = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--warmup")
+        {
+            options.warmup = std::max(0, std::atoi(value.c_str()));
+        }
+        else if(arg == "--tile-size")
+        {
+            options.tileSize = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--viewport")
+        {
+            if(std::sscanf(value.c_str(), "%Lf,%Lf,%Lf,%Lf", &options.left, &options.right, &options.bottom, &options.top) != 4)
+            {
+                return false;
+            }
+        }
+        else if(arg == "--batching")
+        {
+            if(!parseBatching(value, options.batching))
+            {
+                return false;
+            }
+        }
+        else if(arg == "--threading")
+        {
+            if(!parseThreading(value, options.threading))
+            {
+                return false;
+            }
+        }
+        else if(arg == "--kernel")
+        {
+            if(!parseKernel(value, options.kernel))
+            {
+                return false;
+            }
+        }
+        else if(arg == "--isa")
+        {
+            if(!parseIsa(value, options.isa))
+            {
+                return false;
+            }
+        }
+        else if(arg == "--center")
+        {
+            const size_t comma = value.find(',');
+
+            if(comma == std::string::npos)
+            {
+                return false;
+            }
+
+            options.centerReal = value.substr(0u, comma);
+            options.centerImaginary = value.substr(comma + 1u);
+        }
+        else if(arg == "--span")
+        {
+            options.span = std::strtold(value.c_str(), nullptr);
+
+            if(!(options.span > 0.))
+            {
+                return false;
+            }
+        }
+        else if(arg == "--shortcuts" || arg == "--verify" || arg == "--deep-zoom" || arg == "--coalesce")
+        {
+            if(value != "on" && value != "off")
+            {
+                return false;
+            }
+
+            (arg == "--shortcuts" ? options.shortcuts : arg == "--verify" ? options.verify : arg == "--deep-zoom" ? options.deepZoom : options.coalesce) = value == "on";
+        }
+        else if(arg == "--ppm")
+        {
+            options.ppmPath = value;
+        }
+        else if(arg == "--stream")
+        {
+            options.streamPath = value;
+        }
+        else if(arg == "--in-flight")
+        {
+            options.tilesInFlight = std::max(1, std::atoi(value.c_str()));
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+
+    if(!parseArguments(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0] << " [--width N] [--height N] [--iterations N] [--viewport LEFT,RIGHT,BOTTOM,TOP]\n"
+                  << "       [--batching none|batch|tiled|subdivision] [--tile-size N] [--threading none|pool] [--kernel scalar|vector]\n"
+                  << "       [--isa scalar|sse2|avx2|avx512] [--shortcuts on|off] [--verify on|off] [--coalesce on|off]\n"
+                  << "       [--deep-zoom on|off] [--center RE,IM] [--span WIDTH]\n"
+                  << "       [--stream PATH] [--in-flight N]\n"
+                  << "       [--threads N] [--capacity N] [--repeat N] [--warmup N] [--ppm PATH]\n";
+
+        return 1;
+    }
+
+    ThreadPool pool{options.threads};
+
+    pool.setCapacity(options.capacity);
+
+    pool.resume();
+
+    MandelbrotRenderer::init();
+    MandelbrotRenderer::setThreadPool(&pool);
+    MandelbrotRenderer::setIterations(options.iterations);
+    MandelbrotRenderer::setKernelStrategy(options.kernel);
+    MandelbrotRenderer::setTileSize(options.tileSize);
+    MandelbrotKernel::setIsa(options.isa);
+    MandelbrotRenderer::setInteriorShortcuts(options.shortcuts);
+    MandelbrotRenderer::setTaskCoalescing(options.coalesce);
+    MandelbrotRenderer::setLeftEdge(options.left);
+    MandelbrotRenderer::setRightEdge(options.right);
+    MandelbrotRenderer::setBottomEdge(options.bottom);
+    MandelbrotRenderer::setTopEdge(options.top);
+
+    DeepZoomRenderer::init();
+    DeepZoomRenderer::setViewFromRenderer();
+
+    if(!options.centerReal.empty())
+    {
+        const ldouble height = options.span * options.height / options.width;
+
+        DeepZoomRenderer::setViewSize(options.span, height);
+
+        const uint32_t fractionLimbs = DeepZoomRenderer::getCenterReal().getFractionLimbs();
+
+        DeepZoomRenderer::setCenter(BigFloat::fromString(options.centerReal, fractionLimbs), BigFloat::fromString(options.centerImaginary, fractionLimbs));
+
+        // as close as long double gets, for the other renderers and --verify
+        const ldouble real = DeepZoomRenderer::getCenterReal().toLongDouble(), imaginary = DeepZoomRenderer::getCenterImaginary().toLongDouble();
+
+        MandelbrotRenderer::setLeftEdge(real - options.span * 0.5L);
+        MandelbrotRenderer::setRightEdge(real + options.span * 0.5L);
+        MandelbrotRenderer::setBottomEdge(imaginary - height * 0.5L);
+        MandelbrotRenderer::setTopEdge(imaginary + height * 0.5L);
+    }
+
+    const bool streaming = !options.streamPath.empty();
+
+    // a streamed image never exists in memory
+    PixelBuffer image{streaming ? 0u : options.width, streaming ? 0u : options.height};
+
+    auto renderOnce = [&options, &image, streaming]() -> bool
+    {
+        if(!streaming)
+        {
+            render(options.batching, options.threading, options.deepZoom, image);
+
+            return true;
+        }
+
+        if(options.threading == ThreadingStrategy::ENABLE_THREADPOOL)
+        {
+            return StreamingRenderer::render<ThreadingStrategy::ENABLE_THREADPOOL>(options.streamPath, options.width, options.height, options.tilesInFlight);
+        }
+
+        return StreamingRenderer::render<ThreadingStrategy::DISABLE_THREADPOOL>(options.streamPath, options.width, options.height, options.tilesInFlight);
+    };
+
+    for(uint32_t i = 0u; i < options.warmup; ++i)
+    {
+        renderOnce();
+    }
+
+    std::vector<uint64_t> samples;
+
+    for(uint32_t i = 0u; i < options.repeat; ++i)
+    {
+        const uint64_t begin = ThreadPool::now();
+
+        if(!renderOnce())
+        {
+            std::cerr << "failed to map " << options.streamPath << "\n";
+
+            DeepZoomRenderer::deinit();
+            MandelbrotRenderer::deinit();
+
+            return 1;
+        }
+
+        samples.push_back(ThreadPool::now() - begin);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    const double medianMs = static_cast<double>(samples[samples.size() / 2u]) / 1e6;
+
+    const double megapixelsPerSecond = static_cast<double>(options.width) * options.height / (medianMs * 1e3);
+
+    std::cout << "batching,tile_size,threading,kernel,isa,shortcuts,deep_zoom,coalesce,width,height,iterations,threads,repeat,min_ms,median_ms,max_ms,mpixels_per_sec,checksum\n"
+              << toString(options.batching) << ',' << options.tileSize << ',' << toString(options.threading) << ',' << toString(options.kernel) << ','
+              << (options.kernel == KernelStrategy::SCALAR ? "x87" : MandelbrotKernel::toString(MandelbrotKernel::getIsa())) << ','
+              << (options.shortcuts ? "on" : "off") << ',' << (options.deepZoom ? "on" : "off") << ','
+              << (options.coalesce ? "on" : "off") << ',' << options.width << ','
+              << options.height << ',' << options.iterations << ',' << options.threads << ',' << options.repeat << ','
+              << static_cast<double>(samples.front()) / 1e6 << ',' << medianMs << ',' << static_cast<double>(samples.back()) / 1e6 << ','
+              << megapixelsPerSecond << ',' << std::hex << (streaming ? checksum(options.streamPath) : checksum(image)) << std::dec << "\n";
+
+    std::cerr << "peak resident: " << peakResidentKiB() / 1024u << " MiB\n";
+
+    bool isaMismatch = false;
+
+    if(options.verify && !streaming)
+    {
+        PixelBuffer reference{options.width, options.height};
+
+        MandelbrotRenderer::setInteriorShortcuts(false);
+
+        render(options.batching, options.threading, false, reference);
+
+        uint64_t mismatches = 0u;
+
+        for(uint32_t y = 0u; y < options.height; ++y)
+        {
+            for(uint32_t x = 0u; x < options.width; ++x)
+            {
+                const Color lhs = image.getPixel(x, y), rhs = reference.getPixel(x, y);
+
+                mismatches += lhs.r != rhs.r || lhs.g != rhs.g || lhs.b != rhs.b;
+            }
+        }
+
+        std::cerr << "verify: " << mismatches << " of " << static_cast<uint64_t>(options.width) * options.height << " pixels differ from the direct render\n";
+
+        if(options.kernel == KernelStrategy::VECTORIZED && !options.deepZoom)
+        {
+            const MandelbrotKernel::Isa referenceIsa = MandelbrotKernel::getIsa();
+
+            const uint64_t referenceChecksum = checksum(reference);
+
+            for(MandelbrotKernel::Isa isa : {MandelbrotKernel::Isa::SCALAR, MandelbrotKernel::Isa::SSE2, MandelbrotKernel::Isa::AVX2, MandelbrotKernel::Isa::AVX512})
+            {
+                MandelbrotKernel::setIsa(isa);
+
+                // setIsa falls back to the detected isa when the CPU lacks this one
+                if(isa == referenceIsa || MandelbrotKernel::getIsa() != isa)
+                {
+                    continue;
+                }
+
+                PixelBuffer other{options.width, options.height};
+
+                render(options.batching, options.threading, false, other);
+
+                if(checksum(other) != referenceChecksum)
+                {
+                    std::cerr << "verify: isa " << MandelbrotKernel::toString(isa) << " renders checksum " << std::hex << checksum(other)
+                              << ", isa " << MandelbrotKernel::toString(referenceIsa) << " renders " << referenceChecksum << std::dec << "\n";
+
+                    isaMismatch = true;
+                }
+            }
+
+            MandelbrotKernel::setIsa(referenceIsa);
+
+            if(!isaMismatch)
+            {
+                std::cerr << "verify: all supported isas render the same image\n";
+            }
+        }
+    }
+
+    if(!streaming && !options.ppmPath.empty() && !image.saveToPpm(options.ppmPath))
+    {
+        std::cerr << "failed to write " << options.ppmPath << "\n";
+
+        DeepZoomRenderer::deinit();
+        MandelbrotRenderer::deinit();
+
+        return 1;
+    }
+
+    DeepZoomRenderer::deinit();
+    MandelbrotRenderer::deinit();
+
+    return isaMismatch ? 1 : 0;
+}
\ No newline at end of file
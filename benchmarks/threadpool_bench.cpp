@@ -0,0 +1,1080 @@
+#include <ThreadPool.hpp>
+#include <Strand.hpp>
+#include <TaskCoalescer.hpp>
+#include <AsyncPrimitives.hpp>
+#include <Pipeline.hpp>
+#include <ParallelMap.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Self-contained ThreadPool benchmark suite.
+// Usage: threadpool_bench [--repeat N] [--warmup N] [--threads N] [--scale F] [--filter SUBSTR] [--format csv|json] [--record PATH]
+// --record needs a build with THREADPOOL_RECORDING (the threadpool_bench_recording target) and writes every task
+// the selected benchmarks ran to PATH for workload_replay.
+
+struct BenchmarkContext
+{
+    ThreadPool& pool;
+
+    uint32_t threads;
+
+    double scale;
+
+    // number of operations one run performs, used for the throughput column
+    uint64_t operations = 0u;
+
+    // optional per-operation latency, filled by latency oriented benchmarks
+    LatencyHistogram latency;
+
+    uint64_t scaled(uint64_t count) const
+    {
+        return std::max<uint64_t>(1u, static_cast<uint64_t>(static_cast<double>(count) * scale));
+    }
+};
+
+struct Benchmark
+{
+    std::string name;
+
+    std::function<void(BenchmarkContext&)> run;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+
+    uint32_t threads;
+
+    uint32_t repeat;
+
+    uint64_t operations;
+
+    uint64_t minNs;
+
+    uint64_t medianNs;
+
+    uint64_t maxNs;
+
+    double opsPerSecond;
+
+    LatencyHistogram latency;
+};
+
+static void spinFor(uint64_t nanoseconds)
+{
+    const uint64_t deadline = ThreadPool::now() + nanoseconds;
+
+    while(ThreadPool::now() < deadline)
+    {
+    }
+}
+
+static uint64_t fibSerial(uint32_t n)
+{
+    return n < 2u ? n : fibSerial(n - 1u) + fibSerial(n - 2u);
+}
+
+static uint64_t fibTaskCount(uint32_t n, uint32_t cutoff)
+{
+    return n < cutoff ? 1u : 1u + fibTaskCount(n - 1u, cutoff) + fibTaskCount(n - 2u, cutoff);
+}
+
+// fork-join without blocking a worker: every inner node owns a join counter and the last finishing child
+// folds the result upwards, so no task ever waits on a future
+struct FibJoin
+{
+    FibJoin* parent;
+
+    uint64_t* out;
+
+    std::atomic<uint32_t> pending;
+
+    uint64_t left = 0u;
+
+    uint64_t right = 0u;
+
+    std::promise<uint64_t>* done = nullptr;
+
+    FibJoin(FibJoin* parentJoin, uint64_t* result, uint32_t children) : parent{parentJoin}, out{result}, pending{children} {}
+};
+
+static void fibJoin(FibJoin* join)
+{
+    while(join != nullptr && join->pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+    {
+        const uint64_t value = join->left + join->right;
+
+        FibJoin* parent = join->parent;
+
+        if(join->done != nullptr)
+        {
+            join->done->set_value(value);
+        }
+        else
+        {
+            *join->out = value;
+        }
+
+        delete join;
+
+        join = parent;
+    }
+}
+
+static void fibTask(ThreadPool& pool, uint32_t n, uint32_t cutoff, FibJoin* join, uint64_t* out)
+{
+    if(n < cutoff)
+    {
+        *out = fibSerial(n);
+
+        fibJoin(join);
+
+        return;
+    }
+
+    FibJoin* node = new FibJoin{join, out, 2u};
+
+    pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([&pool, n, cutoff, node]() -> void { fibTask(pool, n - 1u, cutoff, node, &node->left); }));
+    pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([&pool, n, cutoff, node]() -> void { fibTask(pool, n - 2u, cutoff, node, &node->right); }));
+}
+
+// open-loop producer with skewed task durations: every 32nd task runs 100x longer. Records submit-to-finish
+// latency of every task, so the tail shows how often short tasks land behind a long one
+static void skewedPlacementLatency(BenchmarkContext& ctx, ThreadPool::PlacementPolicy policy)
+{
+    ctx.pool.setPlacementPolicy(policy);
+
+    const uint64_t count = ctx.scaled(20000u);
+
+    const uint64_t shortDuration = 2000u, longDuration = 200000u;
+
+    // paced to roughly 60% utilization of the pool
+    const uint64_t meanDuration = (31u * shortDuration + longDuration) / 32u;
+
+    const uint64_t interval = meanDuration * 10u / (6u * ctx.threads);
+
+    std::vector<uint64_t> latencies(count);
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+
+    for(uint64_t i = 0u; i < count; ++i)
+    {
+        const uint64_t duration = i % 32u == 0u ? longDuration : shortDuration;
+
+        const uint64_t submitTime = ThreadPool::now();
+
+        futures.push_back(ctx.pool.executeAsync([duration, submitTime, latency = &latencies[i]]() -> void
+        {
+            spinFor(duration);
+
+            *latency = ThreadPool::now() - submitTime;
+        }));
+
+        spinFor(interval);
+    }
+
+    for(auto& future : futures)
+    {
+        future.get();
+    }
+
+    for(uint64_t latency : latencies)
+    {
+        ctx.latency.record(latency);
+    }
+
+    ctx.operations = count;
+}
+
+// tasks building short-lived containers, from the global heap or from the worker's scratch arena
+static void scratchAllocations(BenchmarkContext& ctx, bool useArena)
+{
+    const uint64_t count = ctx.scaled(20000u);
+
+    std::atomic<uint64_t> checksum{0u};
+
+    std::vector<ThreadPool::FunctionWrapper::Ptr> tasks;
+    tasks.reserve(count);
+
+    for(uint64_t i = 0u; i < count; ++i)
+    {
+        tasks.push_back(std::make_unique<ThreadPool::FunctionWrapper>([useArena, i, &checksum]() -> void
+        {
+            std::pmr::memory_resource* resource = useArena ? &ThreadPool::currentWorker().arena() : std::pmr::get_default_resource();
+
+            uint64_t sum = 0u;
+
+            for(uint32_t round = 0u; round < 8u; ++round)
+            {
+                std::pmr::vector<uint32_t> values{resource};
+
+                for(uint32_t k = 0u; k < 64u; ++k)
+                {
+                    values.push_back(static_cast<uint32_t>(i) + k * round);
+                }
+
+                std::pmr::string text{"scratch string long enough to skip the small buffer", resource};
+
+                sum += values.back() + text.size();
+            }
+
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+        }));
+    }
+
+    ctx.pool.addTasksWithBarrier(std::move(tasks), []() -> void {}).get();
+
+    ctx.operations = count;
+}
+
+// how keyedUpdates keeps two updates of one key apart
+enum class KeySerialization
+{
+    // a mutex per key held inside the task
+    MUTEX,
+    // one strand per key
+    STRAND,
+    // executeOn with the key as shard key, all updates of a key run on one worker
+    SHARD
+};
+
+// per-key state machines: every task updates the state of one of 1024 keys
+static void keyedUpdates(BenchmarkContext& ctx, KeySerialization serialization)
+{
+    const bool useStrands = serialization == KeySerialization::STRAND;
+
+    const uint32_t keyCount = 1024u;
+
+    const uint64_t count = ctx.scaled(100000u);
+
+    std::vector<uint64_t> states(keyCount, 0u);
+
+    std::vector<std::mutex> mutexes(serialization == KeySerialization::MUTEX ? keyCount : 0u);
+
+    std::vector<std::unique_ptr<Strand>> strands;
+
+    for(uint32_t key = 0u; useStrands && key < keyCount; ++key)
+    {
+        strands.push_back(std::make_unique<Strand>(ctx.pool));
+    }
+
+    // counted as the last thing a task does, the key's mutex or strand must not be touched once the
+    // benchmark sees the final count and tears them down
+    std::atomic<uint64_t> finished{0u};
+
+    auto update = [&states](uint32_t key) -> void
+    {
+        states[key] = states[key] * 31u + 1u;
+
+        spinFor(200u);
+    };
+
+    for(uint64_t i = 0u; i < count; ++i)
+    {
+        const uint32_t key = static_cast<uint32_t>((i * 2654435761u) % keyCount);
+
+        if(useStrands)
+        {
+            strands[key]->post([&update, &finished, key]() -> void
+            {
+                update(key);
+
+                finished.fetch_add(1u, std::memory_order_release);
+            });
+        }
+        else if(serialization == KeySerialization::SHARD)
+        {
+            ctx.pool.executeOn(key, std::make_unique<ThreadPool::FunctionWrapper>([&update, &finished, key]() -> void
+            {
+                update(key);
+
+                finished.fetch_add(1u, std::memory_order_release);
+            }));
+        }
+        else
+        {
+            ctx.pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([&update, &mutexes, &finished, key]() -> void
+            {
+                {
+                    std::lock_guard<std::mutex> lk{mutexes[key]};
+
+                    update(key);
+                }
+
+                finished.fetch_add(1u, std::memory_order_release);
+            }));
+        }
+    }
+
+    while(finished.load(std::memory_order_acquire) != count)
+    {
+        std::this_thread::yield();
+    }
+
+    ctx.operations = count;
+}
+
+// one chainTask chain of empty tasks, the latency column is the gap between one link finishing and the next
+// one starting
+static void chainTaskDepth(BenchmarkContext& ctx, ThreadPool::ContinuationPolicy policy)
+{
+    const uint64_t depth = ctx.scaled(1000u);
+
+    ctx.pool.setContinuationPolicy(policy);
+
+    // links run one after another, the hand-over between them orders the accesses
+    uint64_t previousEnd = 0u;
+
+    auto link = [&ctx, &previousEnd]() -> void
+    {
+        if(previousEnd != 0u)
+        {
+            ctx.latency.record(ThreadPool::now() - previousEnd);
+        }
+
+        previousEnd = ThreadPool::now();
+    };
+
+    ThreadPool::FunctionWrapper::Ptr head = std::make_unique<ThreadPool::FunctionWrapper>(decltype(link){link});
+
+    ThreadPool::FunctionWrapper::Ptr* tail = &head;
+
+    std::future<void> last;
+
+    for(uint64_t i = 1u; i < depth; ++i)
+    {
+        auto chained = ctx.pool.chainTask(decltype(link){link}, *tail);
+
+        last = std::move(chained.first);
+
+        tail = chained.second;
+    }
+
+    ctx.pool.executeAsync(std::move(head));
+
+    if(last.valid())
+    {
+        last.get();
+    }
+
+    ctx.pool.setContinuationPolicy(ThreadPool::ContinuationPolicy::INLINE);
+
+    ctx.operations = depth;
+}
+
+// 100ns tasks under one barrier, naively one task each, either straight into the pool or through a coalescer
+static void tinyTasks(BenchmarkContext& ctx, bool coalesce)
+{
+    const uint64_t count = ctx.scaled(200000u);
+
+    std::promise<void> done;
+
+    ThreadPool::Barrier* barrier = new ThreadPool::Barrier{static_cast<uint32_t>(count), std::make_unique<ThreadPool::FunctionWrapper>([&done]() -> void { done.set_value(); })};
+
+    std::optional<TaskCoalescer> coalescer;
+
+    if(coalesce)
+    {
+        coalescer.emplace(ctx.pool);
+    }
+
+    for(uint64_t i = 0u; i < count; ++i)
+    {
+        auto task = std::make_unique<ThreadPool::FunctionWrapper>([]() -> void { spinFor(100u); });
+
+        task->barrier() = barrier;
+
+        if(coalescer)
+        {
+            coalescer->submit(std::move(task));
+        }
+        else
+        {
+            ctx.pool.executeAsync(std::move(task));
+        }
+    }
+
+    coalescer.reset();
+
+    done.get_future().get();
+
+    ctx.operations = count;
+}
+
+// one producer and one consumer task per worker over a bounded channel; with blocking primitives twice as
+// many long-lived tasks as workers would deadlock the pool, here a full or empty channel parks the continuation
+static void channelProducerConsumer(BenchmarkContext& ctx)
+{
+    const uint32_t producers = ctx.threads;
+
+    const uint64_t perProducer = ctx.scaled(200000u) / producers + 1u;
+
+    AsyncChannel<uint64_t> channel{ctx.pool, 64u};
+
+    std::atomic<uint32_t> producersLeft{producers};
+
+    std::atomic<uint32_t> consumersLeft{producers};
+
+    std::atomic<uint64_t> checksum{0u};
+
+    std::promise<void> done;
+
+    std::function<void(uint64_t, uint64_t)> produce = [&](uint64_t next, uint64_t end) -> void
+    {
+        if(next == end)
+        {
+            if(producersLeft.fetch_sub(1u) == 1u)
+            {
+                channel.close();
+            }
+
+            return;
+        }
+
+        channel.send(next, [&produce, next, end](bool) -> void { produce(next + 1u, end); });
+    };
+
+    std::function<void()> consume = [&]() -> void
+    {
+        channel.receive([&](std::optional<uint64_t> value) -> void
+        {
+            if(!value)
+            {
+                if(consumersLeft.fetch_sub(1u) == 1u)
+                {
+                    done.set_value();
+                }
+
+                return;
+            }
+
+            spinFor(100u);
+
+            checksum.fetch_add(*value, std::memory_order_relaxed);
+
+            consume();
+        });
+    };
+
+    for(uint32_t i = 0u; i < producers; ++i)
+    {
+        ctx.pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([&consume]() -> void { consume(); }));
+
+        ctx.pool.executeAsync(std::make_unique<ThreadPool::FunctionWrapper>([&produce, i, perProducer]() -> void { produce(i * perProducer, (i + 1u) * perProducer); }));
+    }
+
+    done.get_future().get();
+
+    ctx.operations = perProducer * producers;
+}
+
+// xorshift keys for the sort and scan benchmarks, generated once per size, every run works on a fresh copy
+static const std::vector<uint64_t>& bulkInput(uint64_t count)
+{
+    static std::vector<uint64_t> keys;
+
+    if(keys.size() != count)
+    {
+        keys.resize(count);
+
+        uint64_t state = 0x9E3779B97F4A7C15u;
+
+        for(auto& key : keys)
+        {
+            state ^= state << 13u;
+            state ^= state >> 7u;
+            state ^= state << 17u;
+
+            key = state;
+        }
+    }
+
+    return keys;
+}
+
+// map with skewed task durations and a consumer doing 1us of work per result. Records how long every
+// result sat finished before the consumer got to it, waiting on futures in submission order parks fast
+// results behind slow ones
+static void mapConsumerLag(BenchmarkContext& ctx, bool useFutures, MapOrder order)
+{
+    const uint64_t count = ctx.scaled(5000u);
+
+    std::vector<uint64_t> inputs(count);
+
+    std::iota(inputs.begin(), inputs.end(), uint64_t{0u});
+
+    auto work = [](uint64_t input) -> uint64_t
+    {
+        spinFor(input % 16u == 0u ? 64000u : 2000u);
+
+        return ThreadPool::now();
+    };
+
+    auto consume = [&ctx](uint64_t finishTime) -> void
+    {
+        ctx.latency.record(ThreadPool::now() - finishTime);
+
+        spinFor(1000u);
+    };
+
+    if(useFutures)
+    {
+        std::vector<std::future<uint64_t>> futures;
+        futures.reserve(count);
+
+        for(uint64_t input : inputs)
+        {
+            futures.push_back(ctx.pool.executeAsync([&work, input]() -> uint64_t { return work(input); }));
+        }
+
+        for(auto& future : futures)
+        {
+            consume(future.get());
+        }
+    }
+    else
+    {
+        ParallelMap results{ctx.pool, inputs.begin(), inputs.end(), work, order};
+
+        uint64_t finishTime = 0u;
+
+        while(results.next(finishTime))
+        {
+            consume(finishTime);
+        }
+    }
+
+    ctx.operations = count;
+}
+
+static std::vector<Benchmark> makeBenchmarks()
+{
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({"submit_single_producer", [](BenchmarkContext& ctx) -> void
+    {
+        const uint64_t count = ctx.scaled(100000u);
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(count);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            futures.push_back(ctx.pool.executeAsync([]() -> void {}));
+        }
+
+        for(auto& future : futures)
+        {
+            future.get();
+        }
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"submit_multi_producer", [](BenchmarkContext& ctx) -> void
+    {
+        const uint32_t producers = std::max(2u, ctx.threads);
+
+        const uint64_t perProducer = ctx.scaled(100000u) / producers + 1u;
+
+        std::vector<std::thread> threads;
+
+        for(uint32_t p = 0u; p < producers; ++p)
+        {
+            threads.emplace_back([&ctx, perProducer]() -> void
+            {
+                std::vector<std::future<void>> futures;
+                futures.reserve(perProducer);
+
+                for(uint64_t i = 0u; i < perProducer; ++i)
+                {
+                    futures.push_back(ctx.pool.executeAsync([]() -> void {}));
+                }
+
+                for(auto& future : futures)
+                {
+                    future.get();
+                }
+            });
+        }
+
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        ctx.operations = perProducer * producers;
+    }});
+
+    benchmarks.push_back({"submit_to_start_latency", [](BenchmarkContext& ctx) -> void
+    {
+        const uint64_t count = ctx.scaled(10000u);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            uint64_t startTime = 0u;
+
+            const uint64_t submitTime = ThreadPool::now();
+
+            ctx.pool.executeAsync([&startTime]() -> void { startTime = ThreadPool::now(); }).get();
+
+            ctx.latency.record(startTime - submitTime);
+        }
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"fork_join_fib", [](BenchmarkContext& ctx) -> void
+    {
+        // fib grows by the golden ratio per step, so scale the argument logarithmically
+        const uint32_t cutoff = 12u;
+
+        const uint32_t n = static_cast<uint32_t>(std::max<long>(cutoff, 24l + std::lround(std::log(ctx.scale) / std::log(1.618))));
+
+        std::promise<uint64_t> done;
+
+        auto result = done.get_future();
+
+        FibJoin* root = new FibJoin{nullptr, nullptr, 1u};
+
+        root->done = &done;
+
+        fibTask(ctx.pool, n, cutoff, root, &root->left);
+
+        ALWAYS_ASSERT(result.get() == fibSerial(n));
+
+        ctx.operations = fibTaskCount(n, cutoff);
+    }});
+
+    benchmarks.push_back({"skewed_work_stealing", [](BenchmarkContext& ctx) -> void
+    {
+        // every 16th task is 64x longer, round-robin placement piles them up unless stealing evens it out
+        const uint64_t count = ctx.scaled(2000u);
+
+        std::vector<ThreadPool::FunctionWrapper::Ptr> tasks;
+        tasks.reserve(count);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            const uint64_t duration = i % 16u == 0u ? 64000u : 1000u;
+
+            tasks.push_back(std::make_unique<ThreadPool::FunctionWrapper>([duration]() -> void { spinFor(duration); }));
+        }
+
+        ctx.pool.addTasksWithBarrier(std::move(tasks), []() -> void {}).get();
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"skewed_latency_round_robin", [](BenchmarkContext& ctx) -> void
+    {
+        skewedPlacementLatency(ctx, ThreadPool::PlacementPolicy::ROUND_ROBIN);
+    }});
+
+    benchmarks.push_back({"skewed_latency_two_choices", [](BenchmarkContext& ctx) -> void
+    {
+        skewedPlacementLatency(ctx, ThreadPool::PlacementPolicy::POWER_OF_TWO_CHOICES);
+    }});
+
+    benchmarks.push_back({"scratch_alloc_heap", [](BenchmarkContext& ctx) -> void
+    {
+        scratchAllocations(ctx, false);
+    }});
+
+    benchmarks.push_back({"scratch_alloc_arena", [](BenchmarkContext& ctx) -> void
+    {
+        scratchAllocations(ctx, true);
+    }});
+
+    benchmarks.push_back({"keyed_updates_mutex", [](BenchmarkContext& ctx) -> void
+    {
+        keyedUpdates(ctx, KeySerialization::MUTEX);
+    }});
+
+    benchmarks.push_back({"keyed_updates_strand", [](BenchmarkContext& ctx) -> void
+    {
+        keyedUpdates(ctx, KeySerialization::STRAND);
+    }});
+
+    benchmarks.push_back({"keyed_updates_sharded", [](BenchmarkContext& ctx) -> void
+    {
+        keyedUpdates(ctx, KeySerialization::SHARD);
+    }});
+
+    benchmarks.push_back({"pipeline_read_transform_write", [](BenchmarkContext& ctx) -> void
+    {
+        // serial source, parallel 2us transform, serial in-order sink, 4 items in flight per thread
+        const uint64_t count = ctx.scaled(20000u);
+
+        uint64_t next = 0u, expected = 0u;
+
+        Pipeline pipeline{ctx.pool};
+
+        pipeline.source<uint64_t>([&next, count]() -> std::optional<uint64_t> { return next < count ? std::optional<uint64_t>{next++} : std::nullopt; })
+                .stage<uint64_t, uint64_t>(Pipeline::StageMode::PARALLEL, [](uint64_t value) -> uint64_t { spinFor(2000u); return value; })
+                .sink<uint64_t>(Pipeline::StageMode::SERIAL_IN_ORDER, [&expected](uint64_t value) -> void
+                {
+                    if(value != expected++)
+                    {
+                        std::abort();
+                    }
+                });
+
+        pipeline.run(4u * ctx.threads);
+
+        ctx.operations = count;
+    }});
+
+    // 10^6 elements at --scale 1, --scale 1000 reaches 10^9 given 16 GB of memory
+    benchmarks.push_back({"sort_std", [](BenchmarkContext& ctx) -> void
+    {
+        std::vector<uint64_t> keys = bulkInput(ctx.scaled(1000000u));
+
+        std::sort(keys.begin(), keys.end());
+
+        ctx.operations = keys.size();
+    }});
+
+    benchmarks.push_back({"sort_parallel", [](BenchmarkContext& ctx) -> void
+    {
+        std::vector<uint64_t> keys = bulkInput(ctx.scaled(1000000u));
+
+        ctx.pool.parallelSort(keys.begin(), keys.end());
+
+        ctx.operations = keys.size();
+    }});
+
+    benchmarks.push_back({"inclusive_scan_std", [](BenchmarkContext& ctx) -> void
+    {
+        std::vector<uint64_t> values = bulkInput(ctx.scaled(1000000u));
+
+        std::inclusive_scan(values.begin(), values.end(), values.begin());
+
+        ctx.operations = values.size();
+    }});
+
+    benchmarks.push_back({"inclusive_scan_parallel", [](BenchmarkContext& ctx) -> void
+    {
+        std::vector<uint64_t> values = bulkInput(ctx.scaled(1000000u));
+
+        ctx.pool.parallelInclusiveScan(values.begin(), values.end(), values.begin());
+
+        ctx.operations = values.size();
+    }});
+
+    benchmarks.push_back({"map_futures_in_order", [](BenchmarkContext& ctx) -> void
+    {
+        mapConsumerLag(ctx, true, MapOrder::ORDERED);
+    }});
+
+    benchmarks.push_back({"map_ordered_window", [](BenchmarkContext& ctx) -> void
+    {
+        mapConsumerLag(ctx, false, MapOrder::ORDERED);
+    }});
+
+    benchmarks.push_back({"map_unordered_stream", [](BenchmarkContext& ctx) -> void
+    {
+        mapConsumerLag(ctx, false, MapOrder::UNORDERED);
+    }});
+
+    benchmarks.push_back({"chain_task_depth_inline", [](BenchmarkContext& ctx) -> void
+    {
+        chainTaskDepth(ctx, ThreadPool::ContinuationPolicy::INLINE);
+    }});
+
+    benchmarks.push_back({"chain_task_depth_local", [](BenchmarkContext& ctx) -> void
+    {
+        chainTaskDepth(ctx, ThreadPool::ContinuationPolicy::LOCAL);
+    }});
+
+    benchmarks.push_back({"chain_task_depth_redistribute", [](BenchmarkContext& ctx) -> void
+    {
+        chainTaskDepth(ctx, ThreadPool::ContinuationPolicy::REDISTRIBUTE);
+    }});
+
+    benchmarks.push_back({"barrier_fan_in", [](BenchmarkContext& ctx) -> void
+    {
+        const uint64_t count = ctx.scaled(100000u);
+
+        std::vector<ThreadPool::FunctionWrapper::Ptr> tasks;
+        tasks.reserve(count);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            tasks.push_back(std::make_unique<ThreadPool::FunctionWrapper>([]() -> void {}));
+        }
+
+        ctx.pool.addTasksWithBarrier(std::move(tasks), []() -> void {}).get();
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"when_all_fan_in", [](BenchmarkContext& ctx) -> void
+    {
+        // same shape as barrier_fan_in, but joining futures that already exist
+        const uint64_t count = ctx.scaled(100000u);
+
+        std::vector<Future<void>> futures;
+        futures.reserve(count);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            futures.push_back(ctx.pool.executeFuture([]() -> void {}));
+        }
+
+        whenAll(std::move(futures)).get();
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"when_any_hedged", [](BenchmarkContext& ctx) -> void
+    {
+        // two replicas per request, the first answer wins
+        const uint64_t count = ctx.scaled(10000u);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            const uint64_t submitTime = ThreadPool::now();
+
+            whenAny(ctx.pool.executeFuture([i]() -> uint64_t { spinFor(i % 8u == 0u ? 20000u : 1000u); return i; }),
+                    ctx.pool.executeFuture([i]() -> uint64_t { spinFor(1000u); return i; })).get();
+
+            ctx.latency.record(ThreadPool::now() - submitTime);
+        }
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"tiny_tasks_direct", [](BenchmarkContext& ctx) -> void
+    {
+        tinyTasks(ctx, false);
+    }});
+
+    benchmarks.push_back({"tiny_tasks_coalesced", [](BenchmarkContext& ctx) -> void
+    {
+        tinyTasks(ctx, true);
+    }});
+
+    benchmarks.push_back({"channel_producer_consumer", [](BenchmarkContext& ctx) -> void
+    {
+        channelProducerConsumer(ctx);
+    }});
+
+    benchmarks.push_back({"baseline_std_async", [](BenchmarkContext& ctx) -> void
+    {
+        const uint64_t count = ctx.scaled(2000u);
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(count);
+
+        for(uint64_t i = 0u; i < count; ++i)
+        {
+            futures.push_back(std::async(std::launch::async, []() -> void {}));
+        }
+
+        for(auto& future : futures)
+        {
+            future.get();
+        }
+
+        ctx.operations = count;
+    }});
+
+    benchmarks.push_back({"baseline_std_thread", [](BenchmarkContext& ctx) -> void
+    {
+        const uint64_t count = ctx.scaled(2000u);
+
+        std::vector<std::thread> threads;
+        threads.reserve(ctx.threads);
+
+        for(uint64_t i = 0u; i < count; i += threads.capacity())
+        {
+            for(uint64_t j = i; j < std::min<uint64_t>(count, i + threads.capacity()); ++j)
+            {
+                threads.emplace_back([]() -> void {});
+            }
+
+            for(auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            threads.clear();
+        }
+
+        ctx.operations = count;
+    }});
+
+    return benchmarks;
+}
+
+static BenchmarkResult runBenchmark(const Benchmark& benchmark, ThreadPool& pool, uint32_t threads, double scale, uint32_t warmup, uint32_t repeat)
+{
+    BenchmarkResult result{benchmark.name, threads, repeat, 0u, 0u, 0u, 0u, 0., LatencyHistogram{}};
+
+    for(uint32_t i = 0u; i < warmup; ++i)
+    {
+        BenchmarkContext ctx{pool, threads, scale, 0u, LatencyHistogram{}};
+
+        benchmark.run(ctx);
+    }
+
+    std::vector<uint64_t> samples;
+
+    for(uint32_t i = 0u; i < repeat; ++i)
+    {
+        BenchmarkContext ctx{pool, threads, scale, 0u, LatencyHistogram{}};
+
+        const uint64_t begin = ThreadPool::now();
+
+        benchmark.run(ctx);
+
+        samples.push_back(ThreadPool::now() - begin);
+
+        result.operations = ctx.operations;
+
+        result.latency.merge(ctx.latency);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2u];
+    result.maxNs = samples.back();
+    result.opsPerSecond = static_cast<double>(result.operations) * 1e9 / static_cast<double>(std::max<uint64_t>(result.medianNs, 1u));
+
+    return result;
+}
+
+static void printResults(const std::vector<BenchmarkResult>& results, bool json)
+{
+    if(json)
+    {
+        std::cout << "[\n";
+    }
+    else
+    {
+        std::cout << "name,threads,repeat,operations,min_ns,median_ns,max_ns,ops_per_sec,latency_p50_ns,latency_p99_ns,latency_p999_ns\n";
+    }
+
+    for(size_t i = 0u; i < results.size(); ++i)
+    {
+        const BenchmarkResult& r = results[i];
+
+        if(json)
+        {
+            std::cout << "  {\"name\":\"" << r.name << "\",\"threads\":" << r.threads << ",\"repeat\":" << r.repeat
+                      << ",\"operations\":" << r.operations << ",\"min_ns\":" << r.minNs << ",\"median_ns\":" << r.medianNs
+                      << ",\"max_ns\":" << r.maxNs << ",\"ops_per_sec\":" << r.opsPerSecond
+                      << ",\"latency_p50_ns\":" << r.latency.percentile(50.) << ",\"latency_p99_ns\":" << r.latency.percentile(99.)
+                      << ",\"latency_p999_ns\":" << r.latency.percentile(99.9) << "}" << (i + 1u < results.size() ? "," : "") << "\n";
+        }
+        else
+        {
+            std::cout << r.name << ',' << r.threads << ',' << r.repeat << ',' << r.operations << ',' << r.minNs << ','
+                      << r.medianNs << ',' << r.maxNs << ',' << r.opsPerSecond << ',' << r.latency.percentile(50.) << ','
+                      << r.latency.percentile(99.) << ',' << r.latency.percentile(99.9) << "\n";
+        }
+    }
+
+    if(json)
+    {
+        std::cout << "]\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t repeat = 5u;
+    uint32_t warmup = 1u;
+    uint32_t threads = CpuQuota::availableCpus();
+    double scale = 1.;
+    std::string filter;
+    bool json = false;
+    std::string recordPath;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        const bool hasValue = i + 1 < argc;
+
+        if(arg == "--repeat" && hasValue)
+        {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(arg == "--warmup" && hasValue)
+        {
+            warmup = std::max(0, std::atoi(argv[++i]));
+        }
+        else if(arg == "--threads" && hasValue)
+        {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(arg == "--scale" && hasValue)
+        {
+            scale = std::max(0.001, std::atof(argv[++i]));
+        }
+        else if(arg == "--filter" && hasValue)
+        {
+            filter = argv[++i];
+        }
+        else if(arg == "--format" && hasValue)
+        {
+            json = std::strcmp(argv[++i], "json") == 0;
+        }
+        else if(arg == "--record" && hasValue && THREADPOOL_RECORDING)
+        {
+            recordPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--repeat N] [--warmup N] [--threads N] [--scale F] [--filter SUBSTR] [--format csv|json] [--record PATH]\n";
+
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+
+    for(const Benchmark& benchmark : makeBenchmarks())
+    {
+        if(!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        ThreadPool pool{threads};
+
+        pool.resume();
+
+        results.push_back(runBenchmark(benchmark, pool, threads, scale, warmup, repeat));
+    }
+
+    printResults(results, json);
+
+    if(!recordPath.empty() && !WorkloadRecorder::dump(recordPath))
+    {
+        std::cerr << "failed to write " << recordPath << "\n";
+
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
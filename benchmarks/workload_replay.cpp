@@ -0,0 +1,363 @@
+#include <ThreadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Replays a workload recorded with THREADPOOL_RECORDING against a pool configuration of choice.
+// Usage: workload_replay FILE [--threads N] [--placement round_robin|two_choices] [--speed F] [--repeat N]
+// Every recorded task becomes a busy-spin task of its recorded run time. Tasks submitted from outside the pool
+// are re-issued at their recorded offsets, one replay thread per recorded submitting thread; spawned tasks are
+// submitted by their replayed parent at the same point into its run, continuations are chained to their parent
+// and tasks that shared a barrier share one again. --speed above 1 compresses both arrivals and run times.
+
+using TaskRecord = WorkloadRecorder::TaskRecord;
+
+using Dependency = WorkloadRecorder::Dependency;
+
+struct ReplayOptions
+{
+    std::string path;
+
+    uint32_t threads = CpuQuota::availableCpus();
+
+    ThreadPool::PlacementPolicy placement = ThreadPool::PlacementPolicy::ROUND_ROBIN;
+
+    double speed = 1.;
+
+    uint32_t repeat = 3u;
+};
+
+// the recorded dependency graph, indices into the record vector
+struct ReplayGraph
+{
+    std::vector<TaskRecord> records;
+
+    // per task, spawned children in submission order
+    std::vector<std::vector<uint32_t>> spawned;
+
+    // per task, its continuation or -1
+    std::vector<int64_t> chained;
+
+    // per submitting thread, tasks submitted from outside the pool in submission order
+    std::unordered_map<uint16_t, std::vector<uint32_t>> roots;
+
+    // recorded barrier id to the number of recorded tasks counting towards it
+    std::unordered_map<uint32_t, uint32_t> barrierCounts;
+};
+
+// state of one replay run
+struct ReplayRun
+{
+    const ReplayGraph& graph;
+
+    ThreadPool& pool;
+
+    double speed;
+
+    std::vector<uint64_t> submitted;
+
+    std::vector<uint64_t> started;
+
+    std::unordered_map<uint32_t, ThreadPool::Barrier*> barriers;
+
+    std::atomic<uint64_t> finished{0u};
+};
+
+static void spinUntil(uint64_t deadline)
+{
+    while(ThreadPool::now() < deadline)
+    {
+    }
+}
+
+static uint64_t scaled(uint64_t nanoseconds, double speed)
+{
+    return static_cast<uint64_t>(static_cast<double>(nanoseconds) / speed);
+}
+
+static bool buildGraph(ReplayGraph& graph)
+{
+    const size_t count = graph.records.size();
+
+    std::unordered_map<uint32_t, uint32_t> indexById;
+
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        indexById[graph.records[i].id] = i;
+    }
+
+    graph.spawned.resize(count);
+
+    graph.chained.assign(count, -1);
+
+    // records are sorted by submit time, so children end up in submission order
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        const TaskRecord& record = graph.records[i];
+
+        if(record.barrier != 0u)
+        {
+            ++graph.barrierCounts[record.barrier];
+        }
+
+        auto parent = indexById.find(record.parent);
+
+        if(record.dependency == Dependency::NONE || parent == indexById.end())
+        {
+            // a parent missing from the file, e.g. recording started mid-run, turns the task into a root
+            graph.roots[record.submitThread].push_back(i);
+        }
+        else if(record.dependency == Dependency::SPAWNED)
+        {
+            graph.spawned[parent->second].push_back(i);
+        }
+        else if(graph.chained[parent->second] == -1)
+        {
+            graph.chained[parent->second] = i;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void runReplayTask(ReplayRun& run, uint32_t index);
+
+static ThreadPool::FunctionWrapper::Ptr makeTask(ReplayRun& run, uint32_t index)
+{
+    auto task = std::make_unique<ThreadPool::FunctionWrapper>([&run, index]() -> void { runReplayTask(run, index); });
+
+    const uint32_t barrier = run.graph.records[index].barrier;
+
+    if(barrier != 0u)
+    {
+        task->barrier() = run.barriers.at(barrier);
+    }
+
+    if(run.graph.chained[index] != -1)
+    {
+        task->then() = makeTask(run, static_cast<uint32_t>(run.graph.chained[index]));
+    }
+
+    return task;
+}
+
+static void runReplayTask(ReplayRun& run, uint32_t index)
+{
+    const TaskRecord& record = run.graph.records[index];
+
+    const uint64_t startTime = ThreadPool::now();
+
+    run.started[index] = startTime;
+
+    for(uint32_t child : run.graph.spawned[index])
+    {
+        const TaskRecord& childRecord = run.graph.records[child];
+
+        // the recorded offset into the parent's run, clamped in case the clocks of the two records disagree
+        const uint64_t offset = std::min(childRecord.submitNs - std::min(childRecord.submitNs, record.startNs), record.runNs);
+
+        spinUntil(startTime + scaled(offset, run.speed));
+
+        run.submitted[child] = ThreadPool::now();
+
+        run.pool.executeAsync(makeTask(run, child));
+    }
+
+    spinUntil(startTime + scaled(record.runNs, run.speed));
+
+    if(run.graph.chained[index] != -1)
+    {
+        run.submitted[run.graph.chained[index]] = ThreadPool::now();
+    }
+
+    run.finished.fetch_add(1u, std::memory_order_release);
+}
+
+// makespan of one replay in nanoseconds, queue wait of every task goes to outWait
+static uint64_t replayOnce(const ReplayGraph& graph, ThreadPool& pool, double speed, LatencyHistogram& outWait)
+{
+    ReplayRun run{graph, pool, speed, {}, {}, {}, {0u}};
+
+    run.submitted.assign(graph.records.size(), 0u);
+
+    run.started.assign(graph.records.size(), 0u);
+
+    for(const auto& [barrier, count] : graph.barrierCounts)
+    {
+        run.barriers[barrier] = new ThreadPool::Barrier{count, std::make_unique<ThreadPool::FunctionWrapper>([]() -> void {})};
+    }
+
+    const uint64_t origin = ThreadPool::now() + 1000000u;
+
+    std::vector<std::thread> submitters;
+
+    for(const auto& [thread, roots] : graph.roots)
+    {
+        submitters.emplace_back([&run, &roots = roots, origin]() -> void
+        {
+            for(uint32_t index : roots)
+            {
+                const uint64_t due = origin + scaled(run.graph.records[index].submitNs, run.speed);
+
+                // sleep through long gaps, spin the last stretch for an accurate arrival
+                while(ThreadPool::now() + 200000u < due)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds{100});
+                }
+
+                spinUntil(due);
+
+                run.submitted[index] = ThreadPool::now();
+
+                run.pool.executeAsync(makeTask(run, index));
+            }
+        });
+    }
+
+    for(std::thread& submitter : submitters)
+    {
+        submitter.join();
+    }
+
+    while(run.finished.load(std::memory_order_acquire) != graph.records.size())
+    {
+        std::this_thread::yield();
+    }
+
+    uint64_t end = origin;
+
+    for(uint32_t i = 0u; i < graph.records.size(); ++i)
+    {
+        outWait.record(run.started[i] - run.submitted[i]);
+
+        end = std::max(end, run.started[i] + scaled(graph.records[i].runNs, speed));
+    }
+
+    return end - origin;
+}
+
+static bool parseArguments(int argc, char** argv, ReplayOptions& options)
+{
+    if(argc < 2)
+    {
+        return false;
+    }
+
+    options.path = argv[1];
+
+    for(int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if(i + 1 >= argc)
+        {
+            return false;
+        }
+
+        const std::string value = argv[++i];
+
+        if(arg == "--threads")
+        {
+            options.threads = std::max(1, std::atoi(value.c_str()));
+        }
+        else if(arg == "--placement" && (value == "round_robin" || value == "two_choices"))
+        {
+            options.placement = value == "round_robin" ? ThreadPool::PlacementPolicy::ROUND_ROBIN : ThreadPool::PlacementPolicy::POWER_OF_TWO_CHOICES;
+        }
+        else if(arg == "--speed")
+        {
+            options.speed = std::max(0.001, std::atof(value.c_str()));
+        }
+        else if(arg == "--repeat")
+        {
+            options.repeat = std::max(1, std::atoi(value.c_str()));
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    ReplayOptions options;
+
+    if(!parseArguments(argc, argv, options))
+    {
+        std::cerr << "usage: " << argv[0] << " FILE [--threads N] [--placement round_robin|two_choices] [--speed F] [--repeat N]\n";
+
+        return 1;
+    }
+
+    ReplayGraph graph;
+
+    if(!WorkloadRecorder::load(options.path, graph.records))
+    {
+        std::cerr << "cannot read a workload recording from " << options.path << "\n";
+
+        return 1;
+    }
+
+    if(!buildGraph(graph))
+    {
+        std::cerr << options.path << " has a task with two continuations\n";
+
+        return 1;
+    }
+
+    LatencyHistogram recordedWait;
+
+    uint64_t recordedMakespan = 0u;
+
+    uint32_t recordedThreads = 0u;
+
+    for(const TaskRecord& record : graph.records)
+    {
+        recordedWait.record(record.startNs - record.submitNs);
+
+        recordedMakespan = std::max(recordedMakespan, record.startNs + record.runNs);
+
+        recordedThreads = std::max<uint32_t>(recordedThreads, record.worker + 1u);
+    }
+
+    ThreadPool pool{options.threads};
+
+    pool.setPlacementPolicy(options.placement);
+
+    pool.resume();
+
+    LatencyHistogram replayWait;
+
+    std::vector<uint64_t> makespans;
+
+    for(uint32_t i = 0u; i < options.repeat; ++i)
+    {
+        makespans.push_back(replayOnce(graph, pool, options.speed, replayWait));
+    }
+
+    std::sort(makespans.begin(), makespans.end());
+
+    std::cout << "tasks,recorded_threads,threads,placement,speed,recorded_makespan_ms,replay_makespan_ms,"
+              << "recorded_wait_p50_ns,recorded_wait_p99_ns,replay_wait_p50_ns,replay_wait_p99_ns\n"
+              << graph.records.size() << ',' << recordedThreads << ',' << options.threads << ','
+              << (options.placement == ThreadPool::PlacementPolicy::ROUND_ROBIN ? "round_robin" : "two_choices") << ','
+              << options.speed << ',' << static_cast<double>(scaled(recordedMakespan, options.speed)) / 1e6 << ','
+              << static_cast<double>(makespans[makespans.size() / 2u]) / 1e6 << ',' << recordedWait.percentile(50.) << ','
+              << recordedWait.percentile(99.) << ',' << replayWait.percentile(50.) << ',' << replayWait.percentile(99.) << "\n";
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "DeepZoomRenderer.hpp"
+#include "MandelbrotRenderer.hpp"
+
+// Renders frames in the background so the caller (typically the UI thread) never waits on the pool.
+// Tiles are rendered into a back buffer and published as they finish; once every tile of a frame is
+// done the buffers are swapped. A new frame request cancels the one in flight: its remaining tiles
+// are skipped and the pending parameter updates are applied as soon as the last running tile drains.
+// All public functions must be called from the same thread.
+class AsyncRenderer
+{
+    public:
+
+        struct Rect
+        {
+            uint32_t x0 = 0u;
+            uint32_t y0 = 0u;
+            uint32_t x1 = 0u;
+            uint32_t y1 = 0u;
+        };
+
+        // MandelbrotRenderer has to be initialized, the pool has to be running
+        static void init(ThreadPool* pool, uint32_t width, uint32_t height);
+
+        // waits for the tiles still on the pool
+        static void deinit();
+
+        // queues a change of the renderer parameters (edges, iterations, ...) and starts a new frame.
+        // The update runs on the next poll once no tile reads the parameters anymore.
+        static void requestFrame(std::function<void()> updateParameters = {});
+
+        // publishes tiles finished since the last call into outDirtyTiles, launches pending frames.
+        // Returns true when a frame completed and the buffers were swapped, the tiles reported by that call
+        // are then read from the front buffer.
+        static bool poll(std::vector<Rect>& outDirtyTiles);
+
+        // renders through DeepZoomRenderer (DeepZoomRenderer has to be initialized), takes effect with the next frame
+        static void setDeepZoom(bool enabled);
+
+        static bool getDeepZoom();
+
+        // true while a frame is being rendered or waits to be launched
+        static bool isBusy();
+
+        // last completed frame
+        static const PixelBuffer& getFrontBuffer();
+
+        // frame in progress, the regions reported by poll are complete and safe to read
+        static const PixelBuffer& getBackBuffer();
+
+    private:
+
+        AsyncRenderer() = default;
+
+        static void launchFrame();
+
+        static void submitTiles(uint64_t generation, bool deepZoom);
+
+        static void renderTile(uint64_t generation, Rect tile, bool deepZoom);
+
+        inline static AsyncRenderer* s_instance = nullptr;
+
+        ThreadPool* m_pool = nullptr;
+
+        PixelBuffer m_front;
+        PixelBuffer m_back;
+
+        // bumped by every request, tiles of older generations are skipped
+        std::atomic<uint64_t> m_generation{0u};
+
+        // generation currently rendered into the back buffer
+        uint64_t m_frameGeneration = 0u;
+
+        // tiles submitted to the pool and not finished or skipped yet
+        std::atomic<uint32_t> m_tilesInFlight{0u};
+
+        // tiles of the current frame not published by poll yet
+        uint32_t m_tilesRemaining = 0u;
+
+        std::vector<std::function<void()>> m_pendingUpdates;
+
+        bool m_framePending = false;
+
+        bool m_deepZoom = false;
+
+        std::mutex m_finishedMut;
+
+        std::vector<Rect> m_finishedTiles;
+};
+
+#include "AsyncRenderer.inl"
\ No newline at end of file
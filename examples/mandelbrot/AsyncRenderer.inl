@@ -0,0 +1,246 @@
+#pragma once
+
+#include <thread>
+
+inline void AsyncRenderer::init(ThreadPool* pool, uint32_t width, uint32_t height)
+{
+    ALWAYS_ASSERT(pool != nullptr);
+
+    s_instance = new AsyncRenderer{};
+
+    s_instance->m_pool = pool;
+
+    s_instance->m_front.create(width, height);
+    s_instance->m_back.create(width, height);
+}
+
+inline void AsyncRenderer::deinit()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_generation.fetch_add(1u, std::memory_order_relaxed);
+
+    while(s_instance->m_tilesInFlight.load(std::memory_order_acquire) != 0u)
+    {
+        std::this_thread::yield();
+    }
+
+    delete s_instance;
+
+    s_instance = nullptr;
+}
+
+inline void AsyncRenderer::requestFrame(std::function<void()> updateParameters)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    if(updateParameters)
+    {
+        s_instance->m_pendingUpdates.push_back(std::move(updateParameters));
+    }
+
+    s_instance->m_framePending = true;
+
+    // cancels the frame in flight, its tiles stop reading the parameters at the next row
+    s_instance->m_generation.fetch_add(1u, std::memory_order_relaxed);
+}
+
+inline bool AsyncRenderer::poll(std::vector<Rect>& outDirtyTiles)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    outDirtyTiles.clear();
+
+    if(s_instance->m_framePending)
+    {
+        if(s_instance->m_tilesInFlight.load(std::memory_order_acquire) != 0u)
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{s_instance->m_finishedMut};
+
+            s_instance->m_finishedTiles.clear();
+        }
+
+        launchFrame();
+
+        return false;
+    }
+
+    if(s_instance->m_tilesRemaining == 0u)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{s_instance->m_finishedMut};
+
+        outDirtyTiles.swap(s_instance->m_finishedTiles);
+    }
+
+    s_instance->m_tilesRemaining -= static_cast<uint32_t>(outDirtyTiles.size());
+
+    if(s_instance->m_tilesRemaining != 0u)
+    {
+        return false;
+    }
+
+    std::swap(s_instance->m_front, s_instance->m_back);
+
+    return true;
+}
+
+inline void AsyncRenderer::setDeepZoom(bool enabled)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_deepZoom = enabled;
+}
+
+inline bool AsyncRenderer::getDeepZoom()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_deepZoom;
+}
+
+inline bool AsyncRenderer::isBusy()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_framePending || s_instance->m_tilesRemaining != 0u;
+}
+
+inline const PixelBuffer& AsyncRenderer::getFrontBuffer()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_front;
+}
+
+inline const PixelBuffer& AsyncRenderer::getBackBuffer()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_back;
+}
+
+inline void AsyncRenderer::launchFrame()
+{
+    // nothing reads the parameters at this point
+    for(auto& update : s_instance->m_pendingUpdates)
+    {
+        update();
+    }
+
+    s_instance->m_pendingUpdates.clear();
+
+    s_instance->m_framePending = false;
+
+    s_instance->m_frameGeneration = s_instance->m_generation.load(std::memory_order_relaxed);
+
+    const PixelBuffer::Size imageSize = s_instance->m_back.getSize();
+
+    const auto tiles = MandelbrotRenderer::makeTiles(imageSize.x, imageSize.y);
+
+    s_instance->m_tilesRemaining = static_cast<uint32_t>(tiles.size());
+
+    if(!s_instance->m_deepZoom)
+    {
+        s_instance->m_tilesInFlight.store(static_cast<uint32_t>(tiles.size()), std::memory_order_relaxed);
+
+        submitTiles(s_instance->m_frameGeneration, false);
+
+        return;
+    }
+
+    // the reference orbit is iterated on the pool as well, it counts as one more task in flight
+    s_instance->m_tilesInFlight.store(static_cast<uint32_t>(tiles.size()) + 1u, std::memory_order_relaxed);
+
+    s_instance->m_pool->executeAsync
+    (
+        std::make_unique<ThreadPool::FunctionWrapper>
+        (
+            [generation = s_instance->m_frameGeneration, tileCount = static_cast<uint32_t>(tiles.size())]() -> void
+            {
+                if(s_instance->m_generation.load(std::memory_order_relaxed) != generation)
+                {
+                    s_instance->m_tilesInFlight.fetch_sub(tileCount + 1u, std::memory_order_release);
+
+                    return;
+                }
+
+                const PixelBuffer::Size imageSize = s_instance->m_back.getSize();
+
+                DeepZoomRenderer::prepare(imageSize.x, imageSize.y);
+
+                submitTiles(generation, true);
+
+                s_instance->m_tilesInFlight.fetch_sub(1u, std::memory_order_release);
+            }
+        )
+    );
+}
+
+inline void AsyncRenderer::submitTiles(uint64_t generation, bool deepZoom)
+{
+    const PixelBuffer::Size imageSize = s_instance->m_back.getSize();
+
+    const uint32_t tileSize = MandelbrotRenderer::getTileSize();
+
+    for(const auto& tile : MandelbrotRenderer::makeTiles(imageSize.x, imageSize.y))
+    {
+        const Rect rect{tile.first, tile.second, std::min(tile.first + tileSize, imageSize.x), std::min(tile.second + tileSize, imageSize.y)};
+
+        s_instance->m_pool->executeAsync
+        (
+            std::make_unique<ThreadPool::FunctionWrapper>
+            (
+                [generation, rect, deepZoom]() -> void
+                {
+                    renderTile(generation, rect, deepZoom);
+                }
+            )
+        );
+    }
+}
+
+inline void AsyncRenderer::renderTile(uint64_t generation, Rect tile, bool deepZoom)
+{
+    bool completed = true;
+
+    if(deepZoom)
+    {
+        // glitch correction works on whole tiles, so cancellation does too
+        completed = s_instance->m_generation.load(std::memory_order_relaxed) == generation;
+
+        if(completed)
+        {
+            DeepZoomRenderer::renderRect(s_instance->m_back, tile.x0, tile.y0, tile.x1, tile.y1);
+        }
+    }
+
+    // row by row so a superseded frame releases the pool quickly even at high iteration counts
+    for(uint32_t y = tile.y0; !deepZoom && y < tile.y1; ++y)
+    {
+        if(s_instance->m_generation.load(std::memory_order_relaxed) != generation)
+        {
+            completed = false;
+
+            break;
+        }
+
+        MandelbrotRenderer::renderRect(s_instance->m_back, tile.x0, y, tile.x1, y + 1u);
+    }
+
+    if(completed)
+    {
+        std::lock_guard<std::mutex> lock{s_instance->m_finishedMut};
+
+        s_instance->m_finishedTiles.push_back(tile);
+    }
+
+    s_instance->m_tilesInFlight.fetch_sub(1u, std::memory_order_release);
+}
\ No newline at end of file
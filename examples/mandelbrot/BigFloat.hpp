@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Signed fixed-point number with a 32 bit integer part and a runtime number of 32 bit fraction limbs.
+// Only meant for reference orbits and view centers, i.e. magnitudes well below 2^32. Results take the
+// precision of the left operand; operands are expected to share it.
+class BigFloat
+{
+    public:
+
+        BigFloat() = default;
+
+        explicit BigFloat(uint32_t fractionLimbs, long double value = 0.);
+
+        // decimal notation, e.g. "-0.743643887037158704752191506114774"
+        static BigFloat fromString(const std::string& text, uint32_t fractionLimbs);
+
+        // enough fraction limbs to resolve steps of the given size with 64 bits to spare
+        static uint32_t requiredFractionLimbs(long double resolution);
+
+        uint32_t getFractionLimbs() const { return m_limbs.empty() ? 0u : static_cast<uint32_t>(m_limbs.size() - 1u); }
+
+        // truncates or zero-extends the fraction
+        BigFloat withPrecision(uint32_t fractionLimbs) const;
+
+        double toDouble() const { return static_cast<double>(toLongDouble()); }
+
+        long double toLongDouble() const;
+
+        std::string toString(uint32_t digits) const;
+
+        bool isNegative() const { return m_negative; }
+
+        BigFloat operator-() const;
+
+        friend BigFloat operator+(const BigFloat& lhs, const BigFloat& rhs);
+
+        friend BigFloat operator-(const BigFloat& lhs, const BigFloat& rhs);
+
+        friend BigFloat operator*(const BigFloat& lhs, const BigFloat& rhs);
+
+    private:
+
+        bool isZero() const;
+
+        // |lhs| <=> |rhs|
+        static int compareMagnitude(const BigFloat& lhs, const BigFloat& rhs);
+
+        // signed sum, rhs is negated for subtraction
+        static BigFloat add(const BigFloat& lhs, const BigFloat& rhs, bool negateRhs);
+
+        void divideMagnitude(uint32_t divisor);
+
+        // magnitude, m_limbs[0] is the integer part and m_limbs[i] weighs 2^(-32 i)
+        std::vector<uint32_t> m_limbs;
+
+        bool m_negative = false;
+};
+
+#include "BigFloat.inl"
\ No newline at end of file
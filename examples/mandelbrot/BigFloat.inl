@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+inline BigFloat::BigFloat(uint32_t fractionLimbs, long double value) : m_limbs(fractionLimbs + 1u, 0u), m_negative{value < 0.}
+{
+    long double magnitude = std::abs(value);
+
+    ALWAYS_ASSERT(magnitude < 4294967296.L);
+
+    // long double holds at most 64 significant bits, so this terminates after a few limbs
+    for(uint32_t& limb : m_limbs)
+    {
+        const long double whole = std::floor(magnitude);
+
+        limb = static_cast<uint32_t>(whole);
+
+        magnitude = (magnitude - whole) * 4294967296.L;
+
+        if(magnitude == 0.L)
+        {
+            break;
+        }
+    }
+}
+
+inline BigFloat BigFloat::fromString(const std::string& text, uint32_t fractionLimbs)
+{
+    BigFloat result{fractionLimbs};
+
+    size_t pos = 0u;
+
+    const bool negative = !text.empty() && text[0] == '-';
+
+    if(!text.empty() && (text[0] == '-' || text[0] == '+'))
+    {
+        ++pos;
+    }
+
+    const size_t point = std::min(text.find('.', pos), text.size());
+
+    for(; pos < point; ++pos)
+    {
+        ALWAYS_ASSERT(text[pos] >= '0' && text[pos] <= '9');
+
+        result.m_limbs[0] = result.m_limbs[0] * 10u + static_cast<uint32_t>(text[pos] - '0');
+    }
+
+    // fraction digits from the last one: f = (f + d) / 10
+    BigFloat fraction{fractionLimbs};
+
+    for(size_t i = text.size(); i > point + 1u; --i)
+    {
+        const char digit = text[i - 1u];
+
+        ALWAYS_ASSERT(digit >= '0' && digit <= '9');
+
+        fraction.m_limbs[0] += static_cast<uint32_t>(digit - '0');
+
+        fraction.divideMagnitude(10u);
+    }
+
+    result = result + fraction;
+
+    result.m_negative = negative && !result.isZero();
+
+    return result;
+}
+
+inline uint32_t BigFloat::requiredFractionLimbs(long double resolution)
+{
+    const long double bits = resolution > 0.L ? -std::log2(resolution) : 0.L;
+
+    return std::max(2u, static_cast<uint32_t>(std::ceil((std::max(bits, 0.L) + 64.L) / 32.L)));
+}
+
+inline BigFloat BigFloat::withPrecision(uint32_t fractionLimbs) const
+{
+    BigFloat result = *this;
+
+    result.m_limbs.resize(fractionLimbs + 1u, 0u);
+
+    result.m_negative = m_negative && !result.isZero();
+
+    return result;
+}
+
+inline long double BigFloat::toLongDouble() const
+{
+    long double result = 0.L;
+
+    // limbs past the fourth are below long double's resolution
+    for(size_t i = std::min<size_t>(m_limbs.size(), 4u); i > 0u; --i)
+    {
+        result = result / 4294967296.L + static_cast<long double>(m_limbs[i - 1u]);
+    }
+
+    return m_negative ? -result : result;
+}
+
+inline std::string BigFloat::toString(uint32_t digits) const
+{
+    std::string result = m_negative ? "-" : "";
+
+    result += std::to_string(m_limbs.empty() ? 0u : m_limbs[0]);
+    result += '.';
+
+    BigFloat fraction = withPrecision(getFractionLimbs());
+
+    fraction.m_limbs[0] = 0u;
+
+    for(uint32_t i = 0u; i < digits; ++i)
+    {
+        // f * 10, the carry out of the fraction is the next digit
+        uint64_t carry = 0u;
+
+        for(size_t limb = fraction.m_limbs.size(); limb > 1u; --limb)
+        {
+            const uint64_t product = static_cast<uint64_t>(fraction.m_limbs[limb - 1u]) * 10u + carry;
+
+            fraction.m_limbs[limb - 1u] = static_cast<uint32_t>(product);
+
+            carry = product >> 32u;
+        }
+
+        result += static_cast<char>('0' + carry);
+    }
+
+    return result;
+}
+
+inline BigFloat BigFloat::operator-() const
+{
+    BigFloat result = *this;
+
+    result.m_negative = !m_negative && !isZero();
+
+    return result;
+}
+
+inline BigFloat operator+(const BigFloat& lhs, const BigFloat& rhs)
+{
+    return BigFloat::add(lhs, rhs, false);
+}
+
+inline BigFloat operator-(const BigFloat& lhs, const BigFloat& rhs)
+{
+    return BigFloat::add(lhs, rhs, true);
+}
+
+inline BigFloat operator*(const BigFloat& lhs, const BigFloat& rhs)
+{
+    const size_t size = lhs.m_limbs.size();
+
+    ALWAYS_ASSERT(rhs.m_limbs.size() == size);
+
+    // limb i * limb j lands at weight 2^(-32 (i + j)), everything below limb size - 1 is truncated
+    // except for one guard limb that collects the carries
+    std::vector<uint64_t> accumulator(size + 1u, 0u);
+
+    for(size_t i = 0u; i < size; ++i)
+    {
+        if(lhs.m_limbs[i] == 0u)
+        {
+            continue;
+        }
+
+        for(size_t j = 0u, end = std::min(size - 1u, size - i); j <= end; ++j)
+        {
+            const uint64_t product = static_cast<uint64_t>(lhs.m_limbs[i]) * rhs.m_limbs[j];
+
+            // split so the 64 bit accumulators cannot overflow
+            accumulator[i + j] += product & 0xffffffffu;
+
+            if(i + j > 0u)
+            {
+                accumulator[i + j - 1u] += product >> 32u;
+            }
+            else
+            {
+                ALWAYS_ASSERT((product >> 32u) == 0u && "<-- BigFloat integer part overflow");
+            }
+        }
+    }
+
+    BigFloat result;
+
+    result.m_limbs.resize(size);
+
+    uint64_t carry = 0u;
+
+    for(size_t i = size + 1u; i > 0u; --i)
+    {
+        const uint64_t value = accumulator[i - 1u] + carry;
+
+        if(i - 1u < size)
+        {
+            result.m_limbs[i - 1u] = static_cast<uint32_t>(value);
+        }
+
+        carry = value >> 32u;
+    }
+
+    ALWAYS_ASSERT(carry == 0u && "<-- BigFloat integer part overflow");
+
+    result.m_negative = (lhs.m_negative != rhs.m_negative) && !result.isZero();
+
+    return result;
+}
+
+inline bool BigFloat::isZero() const
+{
+    return std::all_of(m_limbs.begin(), m_limbs.end(), [](uint32_t limb) -> bool { return limb == 0u; });
+}
+
+inline int BigFloat::compareMagnitude(const BigFloat& lhs, const BigFloat& rhs)
+{
+    for(size_t i = 0u; i < lhs.m_limbs.size(); ++i)
+    {
+        if(lhs.m_limbs[i] != rhs.m_limbs[i])
+        {
+            return lhs.m_limbs[i] < rhs.m_limbs[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+inline BigFloat BigFloat::add(const BigFloat& lhs, const BigFloat& rhs, bool negateRhs)
+{
+    const size_t size = lhs.m_limbs.size();
+
+    ALWAYS_ASSERT(rhs.m_limbs.size() == size);
+
+    const bool rhsNegative = rhs.m_negative != negateRhs;
+
+    BigFloat result;
+
+    result.m_limbs.resize(size);
+
+    if(lhs.m_negative == rhsNegative)
+    {
+        uint64_t carry = 0u;
+
+        for(size_t i = size; i > 0u; --i)
+        {
+            const uint64_t sum = static_cast<uint64_t>(lhs.m_limbs[i - 1u]) + rhs.m_limbs[i - 1u] + carry;
+
+            result.m_limbs[i - 1u] = static_cast<uint32_t>(sum);
+
+            carry = sum >> 32u;
+        }
+
+        ALWAYS_ASSERT(carry == 0u && "<-- BigFloat integer part overflow");
+
+        result.m_negative = lhs.m_negative;
+    }
+    else
+    {
+        // subtract the smaller magnitude from the larger one, the result takes the larger one's sign
+        const bool lhsLarger = compareMagnitude(lhs, rhs) >= 0;
+
+        const BigFloat& larger = lhsLarger ? lhs : rhs;
+        const BigFloat& smaller = lhsLarger ? rhs : lhs;
+
+        int64_t borrow = 0;
+
+        for(size_t i = size; i > 0u; --i)
+        {
+            int64_t difference = static_cast<int64_t>(larger.m_limbs[i - 1u]) - smaller.m_limbs[i - 1u] - borrow;
+
+            borrow = difference < 0 ? 1 : 0;
+
+            result.m_limbs[i - 1u] = static_cast<uint32_t>(difference + (borrow << 32));
+        }
+
+        result.m_negative = lhsLarger ? lhs.m_negative : rhsNegative;
+    }
+
+    result.m_negative = result.m_negative && !result.isZero();
+
+    return result;
+}
+
+inline void BigFloat::divideMagnitude(uint32_t divisor)
+{
+    uint64_t remainder = 0u;
+
+    for(uint32_t& limb : m_limbs)
+    {
+        const uint64_t value = (remainder << 32u) | limb;
+
+        limb = static_cast<uint32_t>(value / divisor);
+
+        remainder = value % divisor;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BigFloat.hpp"
+#include "MandelbrotRenderer.hpp"
+
+// Perturbation renderer for zooms past long double precision.
+// One reference orbit is iterated in BigFloat at the view center, every pixel then only tracks its
+// double precision offset from that orbit. Pixels whose offset stops being representable relative to
+// the orbit (Pauldelbrot's criterion) or that outlive the reference are glitched; they are re-rendered
+// against a new reference picked inside the glitch, per tile so the extra orbits run in parallel.
+// Iterations, colors and the pool come from MandelbrotRenderer, which has to be initialized first.
+// Offsets are doubles, so views narrower than ~1e-300 are out of reach.
+class DeepZoomRenderer
+{
+    public:
+
+        static void init() { s_instance = new DeepZoomRenderer{}; }
+
+        static void deinit() { delete s_instance; }
+
+        static void setCenter(const BigFloat& real, const BigFloat& imaginary);
+
+        static const BigFloat& getCenterReal();
+
+        static const BigFloat& getCenterImaginary();
+
+        // extent of the view in the complex plane
+        static void setViewSize(ldouble width, ldouble height);
+
+        static ldouble getViewWidth();
+
+        static ldouble getViewHeight();
+
+        // takes over the edges of MandelbrotRenderer
+        static void setViewFromRenderer();
+
+        // centers the view on a pixel of a width x height image and shrinks it by coefficient
+        static void zoomIntoPixel(uint32_t x, uint32_t y, uint32_t width, uint32_t height, ldouble coefficient);
+
+        // iterates the reference orbit for an image of the given size, required before renderRect
+        static void prepare(uint32_t width, uint32_t height);
+
+        // renders [x0, x1) x [y0, y1) against the prepared reference, safe to call from several threads
+        static void renderRect(PixelBuffer& inoutImage, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+        template<MandelbrotRenderer::ThreadingStrategy threadingStrategy = MandelbrotRenderer::ThreadingStrategy::DISABLE_THREADPOOL>
+        static void render(PixelBuffer& inoutImage);
+
+    private:
+
+        DeepZoomRenderer() = default;
+
+        struct ReferenceOrbit
+        {
+            // Z_0 = 0 up to the first escaping value or Z_(maxIterations + 1)
+            std::vector<double> real;
+            std::vector<double> imaginary;
+
+            // pixel coordinates of the reference point
+            double x = 0.;
+            double y = 0.;
+        };
+
+        // a pixel is glitched once |z|^2 drops below this fraction of |Z|^2
+        static constexpr double GLITCH_TOLERANCE = 1e-6;
+
+        // references tried per tile before the remaining glitched pixels are iterated in BigFloat directly
+        static constexpr uint32_t MAX_REFERENCES_PER_TILE = 8u;
+
+        static constexpr uint32_t GLITCHED = UINT32_MAX;
+
+        static void computeOrbit(const BigFloat& real, const BigFloat& imaginary, uint32_t maxIterations, ReferenceOrbit& outOrbit);
+
+        // iteration count with MandelbrotRenderer's numbering, GLITCHED with the |z|^2 / |Z|^2 ratio otherwise
+        static uint32_t iteratePixel(const ReferenceOrbit& orbit, double dcReal, double dcImaginary, uint32_t maxIterations, double& outGlitchRatio);
+
+        // exact point of pixel (x, y) for the prepared image size
+        static std::pair<BigFloat, BigFloat> pixelToPoint(double x, double y);
+
+        inline static DeepZoomRenderer* s_instance = nullptr;
+
+        BigFloat m_centerReal{2u};
+        BigFloat m_centerImaginary{2u};
+
+        ldouble m_viewWidth = 4.;
+        ldouble m_viewHeight = 4.;
+
+        // state of the last prepare call, read concurrently by renderRect
+        ReferenceOrbit m_reference;
+
+        uint32_t m_imageWidth = 0u;
+        uint32_t m_imageHeight = 0u;
+
+        double m_pixelWidth = 0.;
+        double m_pixelHeight = 0.;
+};
+
+#include "DeepZoomRenderer.inl"
\ No newline at end of file
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+
+inline void DeepZoomRenderer::setCenter(const BigFloat& real, const BigFloat& imaginary)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    const uint32_t fractionLimbs = BigFloat::requiredFractionLimbs(std::min(s_instance->m_viewWidth, s_instance->m_viewHeight) / 65536.L);
+
+    s_instance->m_centerReal = real.withPrecision(std::max(fractionLimbs, real.getFractionLimbs()));
+    s_instance->m_centerImaginary = imaginary.withPrecision(s_instance->m_centerReal.getFractionLimbs());
+}
+
+inline const BigFloat& DeepZoomRenderer::getCenterReal()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_centerReal;
+}
+
+inline const BigFloat& DeepZoomRenderer::getCenterImaginary()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_centerImaginary;
+}
+
+inline void DeepZoomRenderer::setViewSize(ldouble width, ldouble height)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+    ALWAYS_ASSERT(width > 0. && height > 0.);
+
+    s_instance->m_viewWidth = width;
+    s_instance->m_viewHeight = height;
+
+    // pixels of images up to 65536 wide still land on exact BigFloat values
+    setCenter(s_instance->m_centerReal, s_instance->m_centerImaginary);
+}
+
+inline ldouble DeepZoomRenderer::getViewWidth()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_viewWidth;
+}
+
+inline ldouble DeepZoomRenderer::getViewHeight()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_viewHeight;
+}
+
+inline void DeepZoomRenderer::setViewFromRenderer()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    const ldouble width = MandelbrotRenderer::getRightEdge() - MandelbrotRenderer::getLeftEdge();
+    const ldouble height = MandelbrotRenderer::getTopEdge() - MandelbrotRenderer::getBottomEdge();
+
+    setViewSize(width, height);
+
+    const uint32_t fractionLimbs = s_instance->m_centerReal.getFractionLimbs();
+
+    setCenter
+    (
+        BigFloat{fractionLimbs, MandelbrotRenderer::getLeftEdge() + width * 0.5L},
+        BigFloat{fractionLimbs, MandelbrotRenderer::getBottomEdge() + height * 0.5L}
+    );
+}
+
+inline void DeepZoomRenderer::zoomIntoPixel(uint32_t x, uint32_t y, uint32_t width, uint32_t height, ldouble coefficient)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    const uint32_t fractionLimbs = s_instance->m_centerReal.getFractionLimbs();
+
+    // same mapping as MandelbrotRenderer: x runs from the left edge, y from the bottom edge
+    const ldouble offsetReal = (static_cast<ldouble>(x) / width - 0.5L) * s_instance->m_viewWidth;
+    const ldouble offsetImaginary = (static_cast<ldouble>(y) / height - 0.5L) * s_instance->m_viewHeight;
+
+    const BigFloat real = s_instance->m_centerReal + BigFloat{fractionLimbs, offsetReal};
+    const BigFloat imaginary = s_instance->m_centerImaginary + BigFloat{fractionLimbs, offsetImaginary};
+
+    setViewSize(s_instance->m_viewWidth / coefficient, s_instance->m_viewHeight / coefficient);
+
+    setCenter(real, imaginary);
+}
+
+inline void DeepZoomRenderer::prepare(uint32_t width, uint32_t height)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_imageWidth = width;
+    s_instance->m_imageHeight = height;
+
+    s_instance->m_pixelWidth = static_cast<double>(s_instance->m_viewWidth / width);
+    s_instance->m_pixelHeight = static_cast<double>(s_instance->m_viewHeight / height);
+
+    computeOrbit(s_instance->m_centerReal, s_instance->m_centerImaginary, MandelbrotRenderer::getIterations(), s_instance->m_reference);
+
+    s_instance->m_reference.x = width * 0.5;
+    s_instance->m_reference.y = height * 0.5;
+}
+
+inline void DeepZoomRenderer::renderRect(PixelBuffer& inoutImage, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+    ALWAYS_ASSERT(inoutImage.getSize().x == s_instance->m_imageWidth && inoutImage.getSize().y == s_instance->m_imageHeight && "<-- assert missed prepare call");
+
+    const uint32_t maxIterations = MandelbrotRenderer::getIterations();
+
+    const double pixelWidth = s_instance->m_pixelWidth;
+    const double pixelHeight = s_instance->m_pixelHeight;
+
+    thread_local std::vector<std::pair<uint32_t, uint32_t>> glitched, stillGlitched;
+    thread_local std::vector<double> ratios, stillRatios;
+
+    thread_local ReferenceOrbit secondary;
+
+    glitched.clear();
+    ratios.clear();
+
+    const ReferenceOrbit* orbit = &s_instance->m_reference;
+
+    for(uint32_t y = y0; y < y1; ++y)
+    {
+        for(uint32_t x = x0; x < x1; ++x)
+        {
+            double ratio = 0.;
+
+            const uint32_t iterations = iteratePixel(*orbit, (x - orbit->x) * pixelWidth, (y - orbit->y) * pixelHeight, maxIterations, ratio);
+
+            if(iterations == GLITCHED)
+            {
+                glitched.emplace_back(x, y);
+                ratios.push_back(ratio);
+
+                continue;
+            }
+
+            inoutImage.setPixel(x, y, MandelbrotRenderer::colorFromIterations(iterations));
+        }
+    }
+
+    for(uint32_t reference = 1u; !glitched.empty(); ++reference)
+    {
+        // the pixel that lost the most precision sits closest to the glitch core
+        const size_t pick = static_cast<size_t>(std::min_element(ratios.begin(), ratios.end()) - ratios.begin());
+
+        // out of references: every pixel becomes its own, which cannot glitch
+        const bool exact = reference >= MAX_REFERENCES_PER_TILE;
+
+        if(!exact)
+        {
+            const auto point = pixelToPoint(glitched[pick].first, glitched[pick].second);
+
+            computeOrbit(point.first, point.second, maxIterations, secondary);
+
+            secondary.x = glitched[pick].first;
+            secondary.y = glitched[pick].second;
+        }
+
+        stillGlitched.clear();
+        stillRatios.clear();
+
+        for(size_t i = 0u; i < glitched.size(); ++i)
+        {
+            const uint32_t x = glitched[i].first, y = glitched[i].second;
+
+            if(exact)
+            {
+                const auto pixelPoint = pixelToPoint(x, y);
+
+                computeOrbit(pixelPoint.first, pixelPoint.second, maxIterations, secondary);
+
+                secondary.x = x;
+                secondary.y = y;
+            }
+
+            double ratio = 0.;
+
+            const uint32_t iterations = iteratePixel(secondary, (x - secondary.x) * pixelWidth, (y - secondary.y) * pixelHeight, maxIterations, ratio);
+
+            if(iterations == GLITCHED)
+            {
+                stillGlitched.push_back(glitched[i]);
+                stillRatios.push_back(ratio);
+
+                continue;
+            }
+
+            inoutImage.setPixel(x, y, MandelbrotRenderer::colorFromIterations(iterations));
+        }
+
+        std::swap(glitched, stillGlitched);
+        std::swap(ratios, stillRatios);
+    }
+}
+
+template<MandelbrotRenderer::ThreadingStrategy threadingStrategy>
+void DeepZoomRenderer::render(PixelBuffer& inoutImage)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    const auto imageSize = inoutImage.getSize();
+
+    prepare(imageSize.x, imageSize.y);
+
+    const uint32_t tileSize = MandelbrotRenderer::getTileSize();
+
+    const auto tiles = MandelbrotRenderer::makeTiles(imageSize.x, imageSize.y);
+
+    if constexpr (threadingStrategy == MandelbrotRenderer::ThreadingStrategy::DISABLE_THREADPOOL)
+    {
+        for(const auto& tile : tiles)
+        {
+            renderRect(inoutImage, tile.first, tile.second, std::min(tile.first + tileSize, imageSize.x), std::min(tile.second + tileSize, imageSize.y));
+        }
+    }
+
+    if constexpr (threadingStrategy == MandelbrotRenderer::ThreadingStrategy::ENABLE_THREADPOOL)
+    {
+        std::vector<ThreadPool::FunctionWrapper::Ptr> tasks;
+        tasks.reserve(tiles.size());
+
+        for(const auto& tile : tiles)
+        {
+            const uint32_t x1 = std::min(tile.first + tileSize, imageSize.x);
+            const uint32_t y1 = std::min(tile.second + tileSize, imageSize.y);
+
+            tasks.push_back
+            (
+                std::make_unique<ThreadPool::FunctionWrapper>
+                (
+                    [tile, x1, y1, &inoutImage]() -> void
+                    {
+                        renderRect(inoutImage, tile.first, tile.second, x1, y1);
+                    }
+                )
+            );
+        }
+
+        auto onComplete = MandelbrotRenderer::getThreadPool()->addTasksWithBarrier(std::move(tasks), []() -> bool { return true; });
+        onComplete.get();
+    }
+}
+
+inline void DeepZoomRenderer::computeOrbit(const BigFloat& real, const BigFloat& imaginary, uint32_t maxIterations, ReferenceOrbit& outOrbit)
+{
+    outOrbit.real.clear();
+    outOrbit.imaginary.clear();
+
+    outOrbit.real.push_back(0.);
+    outOrbit.imaginary.push_back(0.);
+
+    const uint32_t fractionLimbs = real.getFractionLimbs();
+
+    BigFloat zReal{fractionLimbs}, zImaginary{fractionLimbs};
+
+    for(uint32_t n = 0u; n <= maxIterations; ++n)
+    {
+        // three multiplications: 2xy = (x + y)^2 - x^2 - y^2
+        const BigFloat realSquared = zReal * zReal;
+        const BigFloat imaginarySquared = zImaginary * zImaginary;
+        const BigFloat sum = zReal + zImaginary;
+
+        zImaginary = sum * sum - realSquared - imaginarySquared + imaginary;
+        zReal = realSquared - imaginarySquared + real;
+
+        const double r = zReal.toDouble(), i = zImaginary.toDouble();
+
+        outOrbit.real.push_back(r);
+        outOrbit.imaginary.push_back(i);
+
+        // like the pixels, Z_1 = C is never tested
+        if(n > 0u && r * r + i * i > MandelbrotKernel::ESCAPE_RADIUS_SQUARED)
+        {
+            break;
+        }
+    }
+}
+
+inline uint32_t DeepZoomRenderer::iteratePixel(const ReferenceOrbit& orbit, double dcReal, double dcImaginary, uint32_t maxIterations, double& outGlitchRatio)
+{
+    const size_t last = orbit.real.size() - 1u;
+
+    double dzReal = 0., dzImaginary = 0.;
+
+    // z_k = Z_k + dz_k with dz_k = (2 Z_(k-1) + dz_(k-1)) dz_(k-1) + dc; MandelbrotRenderer reports z_2 escaping as 0
+    for(uint32_t k = 1u; k <= maxIterations + 1u; ++k)
+    {
+        if(k > last)
+        {
+            // the reference escaped first, any other reference does better
+            outGlitchRatio = 1.;
+
+            return GLITCHED;
+        }
+
+        const double twoZdzReal = 2. * orbit.real[k - 1u] + dzReal;
+        const double twoZdzImaginary = 2. * orbit.imaginary[k - 1u] + dzImaginary;
+
+        const double nextReal = twoZdzReal * dzReal - twoZdzImaginary * dzImaginary + dcReal;
+        const double nextImaginary = twoZdzReal * dzImaginary + twoZdzImaginary * dzReal + dcImaginary;
+
+        dzReal = nextReal;
+        dzImaginary = nextImaginary;
+
+        const double zReal = orbit.real[k] + dzReal;
+        const double zImaginary = orbit.imaginary[k] + dzImaginary;
+
+        const double magnitude = zReal * zReal + zImaginary * zImaginary;
+
+        if(k >= 2u && magnitude > MandelbrotKernel::ESCAPE_RADIUS_SQUARED)
+        {
+            return k - 2u;
+        }
+
+        const double referenceMagnitude = orbit.real[k] * orbit.real[k] + orbit.imaginary[k] * orbit.imaginary[k];
+
+        if(magnitude < GLITCH_TOLERANCE * referenceMagnitude)
+        {
+            outGlitchRatio = magnitude / referenceMagnitude;
+
+            return GLITCHED;
+        }
+    }
+
+    return maxIterations;
+}
+
+inline std::pair<BigFloat, BigFloat> DeepZoomRenderer::pixelToPoint(double x, double y)
+{
+    const uint32_t fractionLimbs = s_instance->m_centerReal.getFractionLimbs();
+
+    // small integer times a double is exact in long double, and the center has bits to spare below a pixel
+    const ldouble offsetReal = (static_cast<ldouble>(x) - s_instance->m_reference.x) * s_instance->m_pixelWidth;
+    const ldouble offsetImaginary = (static_cast<ldouble>(y) - s_instance->m_reference.y) * s_instance->m_pixelHeight;
+
+    return {s_instance->m_centerReal + BigFloat{fractionLimbs, offsetReal}, s_instance->m_centerImaginary + BigFloat{fractionLimbs, offsetImaginary}};
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+set(CMAKE_REQUIRED_FLAGS -std=c++17)
+
+add_library(Mandelbrot::Mandelbrot INTERFACE IMPORTED)
+
+target_include_directories(Mandelbrot::Mandelbrot INTERFACE ${CMAKE_CURRENT_LIST_DIR})
+
+target_link_libraries(Mandelbrot::Mandelbrot INTERFACE ThreadPool::ThreadPool)
+
+target_compile_features(Mandelbrot::Mandelbrot INTERFACE cxx_std_17)
\ No newline at end of file
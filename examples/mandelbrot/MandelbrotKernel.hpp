@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define MANDELBROT_X86 1
+#else
+    #define MANDELBROT_X86 0
+#endif
+
+// GCC and Clang only emit AVX code inside functions that opt in, MSVC accepts the intrinsics anywhere
+#if MANDELBROT_X86 && (defined(__GNUC__) || defined(__clang__))
+    #define MANDELBROT_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define MANDELBROT_TARGET(isa)
+#endif
+
+// Escape-time iteration counts for batches of points in double precision.
+// The widest instruction set supported by the CPU is picked once at startup.
+class MandelbrotKernel
+{
+    public:
+
+        enum class Isa
+        {
+            SCALAR,
+            SSE2,
+            AVX2,
+            AVX512
+        };
+
+        // squared escape radius shared by every kernel
+        static constexpr double ESCAPE_RADIUS_SQUARED = 16.;
+
+        // orbits closer than this to their last Brent checkpoint are treated as cycles, i.e. inside the set
+        static constexpr double PERIODICITY_EPSILON = 1e-13;
+
+        // writes the index of the first iteration whose |z|^2 exceeds the escape radius, maxIterations if none does;
+        // with shortcuts, points in the main cardioid, the period-2 bulb or on a detected cycle report maxIterations early
+        static void computeIterations(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations, bool shortcuts = false);
+
+        template<typename T> static bool isInsideMainBulbs(T cr, T ci);
+
+        static Isa detectIsa();
+
+        static Isa getIsa();
+
+        // overriding with an isa the CPU lacks falls back to the detected one
+        static void setIsa(Isa isa);
+
+        static const char* toString(Isa isa);
+
+    private:
+
+        template<bool periodicity> static void dispatch(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations);
+
+        template<bool periodicity> static void computeScalar(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations);
+
+#if MANDELBROT_X86
+        template<bool periodicity> MANDELBROT_TARGET("sse2")
+        static void computeSse2(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations);
+
+        template<bool periodicity> MANDELBROT_TARGET("avx2")
+        static void computeAvx2(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations);
+
+        template<bool periodicity> MANDELBROT_TARGET("avx512f")
+        static void computeAvx512(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations);
+#endif
+
+        inline static Isa s_isa = detectIsa();
+};
+
+#include "MandelbrotKernel.inl"
\ No newline at end of file
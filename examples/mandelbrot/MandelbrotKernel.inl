@@ -0,0 +1,475 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#if MANDELBROT_X86
+    #include <immintrin.h>
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+// Every kernel has to produce the same iteration counts. The avx512f target (and -march=native) enables FMA, and
+// GCC would fuse the z^2 + c multiply-adds there with a different rounding, so points near the boundary escape
+// at other iterations than on the other ISAs. Clang only contracts within a single expression and never across
+// intrinsics.
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC push_options
+    #pragma GCC optimize("fp-contract=off")
+#endif
+
+inline MandelbrotKernel::Isa MandelbrotKernel::detectIsa()
+{
+#if MANDELBROT_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f"))
+    {
+        return Isa::AVX512;
+    }
+
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return Isa::AVX2;
+    }
+
+    if(__builtin_cpu_supports("sse2"))
+    {
+        return Isa::SSE2;
+    }
+#elif MANDELBROT_X86 && defined(_MSC_VER)
+    int info[4] = {};
+
+    __cpuid(info, 0);
+
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+
+    // the OS must save the wide registers on context switches, checked through XCR0
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0u;
+
+    if(maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+
+        if((info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6u) == 0xE6u)
+        {
+            return Isa::AVX512;
+        }
+
+        if((info[1] & (1 << 5)) != 0 && (xcr0 & 0x6u) == 0x6u)
+        {
+            return Isa::AVX2;
+        }
+    }
+
+    if(sse2)
+    {
+        return Isa::SSE2;
+    }
+#endif
+
+    return Isa::SCALAR;
+}
+
+inline MandelbrotKernel::Isa MandelbrotKernel::getIsa()
+{
+    return s_isa;
+}
+
+inline void MandelbrotKernel::setIsa(Isa isa)
+{
+    s_isa = static_cast<int>(isa) <= static_cast<int>(detectIsa()) ? isa : detectIsa();
+}
+
+inline const char* MandelbrotKernel::toString(Isa isa)
+{
+    switch(isa)
+    {
+        case Isa::SCALAR: return "scalar";
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        case Isa::AVX512: return "avx512";
+    }
+
+    return "unknown";
+}
+
+inline void MandelbrotKernel::computeIterations(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations, bool shortcuts)
+{
+    if(!shortcuts)
+    {
+        dispatch<false>(cr, ci, count, maxIterations, outIterations);
+
+        return;
+    }
+
+    // points inside the cardioid or the period-2 bulb never reach the kernel, the rest are compacted so the
+    // vector lanes stay full
+    thread_local std::vector<double> compactCr, compactCi;
+    thread_local std::vector<uint32_t> compactIndex, compactIterations;
+
+    compactCr.clear();
+    compactCi.clear();
+    compactIndex.clear();
+
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        if(isInsideMainBulbs(cr[i], ci[i]))
+        {
+            outIterations[i] = maxIterations;
+        }
+        else
+        {
+            compactCr.push_back(cr[i]);
+            compactCi.push_back(ci[i]);
+            compactIndex.push_back(i);
+        }
+    }
+
+    compactIterations.resize(compactIndex.size());
+
+    dispatch<true>(compactCr.data(), compactCi.data(), static_cast<uint32_t>(compactIndex.size()), maxIterations, compactIterations.data());
+
+    for(size_t i = 0u; i < compactIndex.size(); ++i)
+    {
+        outIterations[compactIndex[i]] = compactIterations[i];
+    }
+}
+
+template<typename T> bool MandelbrotKernel::isInsideMainBulbs(T cr, T ci)
+{
+    // main cardioid
+    const T shifted = cr - T{0.25};
+
+    const T q = shifted * shifted + ci * ci;
+
+    if(q * (q + shifted) <= T{0.25} * ci * ci)
+    {
+        return true;
+    }
+
+    // period-2 bulb centred at -1 with radius 1/4
+    return (cr + T{1.}) * (cr + T{1.}) + ci * ci <= T{0.0625};
+}
+
+template<bool periodicity> void MandelbrotKernel::dispatch(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations)
+{
+    switch(s_isa)
+    {
+#if MANDELBROT_X86
+        case Isa::AVX512:
+            computeAvx512<periodicity>(cr, ci, count, maxIterations, outIterations);
+            return;
+
+        case Isa::AVX2:
+            computeAvx2<periodicity>(cr, ci, count, maxIterations, outIterations);
+            return;
+
+        case Isa::SSE2:
+            computeSse2<periodicity>(cr, ci, count, maxIterations, outIterations);
+            return;
+#endif
+
+        default:
+            computeScalar<periodicity>(cr, ci, count, maxIterations, outIterations);
+            return;
+    }
+}
+
+template<bool periodicity> void MandelbrotKernel::computeScalar(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations)
+{
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        double a = cr[i], b = ci[i];
+
+        // Brent: compare against an orbit point saved at power-of-two iterations, a match means a cycle
+        double savedA = a, savedB = b;
+
+        uint32_t checkpoint = 1u;
+
+        uint32_t iteration = 0u;
+
+        for(; iteration < maxIterations; ++iteration)
+        {
+            double aa = a*a - b*b, bb = 2. * a*b;
+            a = aa + cr[i];
+            b = bb + ci[i];
+
+            if(a*a + b*b > ESCAPE_RADIUS_SQUARED)
+            {
+                break;
+            }
+
+            if constexpr (periodicity)
+            {
+                if(std::abs(a - savedA) < PERIODICITY_EPSILON && std::abs(b - savedB) < PERIODICITY_EPSILON)
+                {
+                    iteration = maxIterations;
+
+                    break;
+                }
+
+                if(iteration == checkpoint)
+                {
+                    savedA = a;
+                    savedB = b;
+
+                    checkpoint <<= 1u;
+                }
+            }
+        }
+
+        outIterations[i] = iteration;
+    }
+}
+
+#if MANDELBROT_X86
+
+// All vector kernels follow the scalar loop lane by lane: a lane stops counting once its escape mask is set
+// and the group finishes when every lane has escaped, turned out periodic or maxIterations is reached.
+// Periodic lanes are reported as maxIterations. Tails go through computeScalar.
+
+template<bool periodicity> MANDELBROT_TARGET("sse2")
+void MandelbrotKernel::computeSse2(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations)
+{
+    const __m128d radius = _mm_set1_pd(ESCAPE_RADIUS_SQUARED);
+    const __m128d one = _mm_set1_pd(1.);
+    const __m128d epsilon = _mm_set1_pd(PERIODICITY_EPSILON);
+    const __m128d signMask = _mm_set1_pd(-0.);
+
+    uint32_t i = 0u;
+
+    for(; i + 2u <= count; i += 2u)
+    {
+        const __m128d x0 = _mm_loadu_pd(cr + i);
+        const __m128d y0 = _mm_loadu_pd(ci + i);
+
+        __m128d a = x0, b = y0;
+        __m128d savedA = a, savedB = b;
+        __m128d iterations = _mm_setzero_pd();
+        __m128d active = _mm_castsi128_pd(_mm_set1_epi32(-1));
+        __m128d periodic = _mm_setzero_pd();
+
+        uint32_t checkpoint = 1u;
+
+        for(uint32_t iteration = 0u; iteration < maxIterations; ++iteration)
+        {
+            const __m128d ab = _mm_mul_pd(a, b);
+
+            a = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(a, a), _mm_mul_pd(b, b)), x0);
+            b = _mm_add_pd(_mm_add_pd(ab, ab), y0);
+
+            const __m128d magnitude = _mm_add_pd(_mm_mul_pd(a, a), _mm_mul_pd(b, b));
+
+            active = _mm_and_pd(active, _mm_cmple_pd(magnitude, radius));
+
+            if constexpr (periodicity)
+            {
+                const __m128d closeA = _mm_cmplt_pd(_mm_andnot_pd(signMask, _mm_sub_pd(a, savedA)), epsilon);
+                const __m128d closeB = _mm_cmplt_pd(_mm_andnot_pd(signMask, _mm_sub_pd(b, savedB)), epsilon);
+
+                const __m128d cycle = _mm_and_pd(active, _mm_and_pd(closeA, closeB));
+
+                periodic = _mm_or_pd(periodic, cycle);
+                active = _mm_andnot_pd(cycle, active);
+
+                if(iteration == checkpoint)
+                {
+                    savedA = a;
+                    savedB = b;
+
+                    checkpoint <<= 1u;
+                }
+            }
+
+            if(_mm_movemask_pd(active) == 0)
+            {
+                break;
+            }
+
+            iterations = _mm_add_pd(iterations, _mm_and_pd(active, one));
+        }
+
+        if constexpr (periodicity)
+        {
+            const __m128d limit = _mm_set1_pd(static_cast<double>(maxIterations));
+
+            iterations = _mm_or_pd(_mm_and_pd(periodic, limit), _mm_andnot_pd(periodic, iterations));
+        }
+
+        alignas(16) double result[2];
+
+        _mm_store_pd(result, iterations);
+
+        outIterations[i] = static_cast<uint32_t>(result[0]);
+        outIterations[i + 1u] = static_cast<uint32_t>(result[1]);
+    }
+
+    computeScalar<periodicity>(cr + i, ci + i, count - i, maxIterations, outIterations + i);
+}
+
+template<bool periodicity> MANDELBROT_TARGET("avx2")
+void MandelbrotKernel::computeAvx2(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations)
+{
+    const __m256d radius = _mm256_set1_pd(ESCAPE_RADIUS_SQUARED);
+    const __m256d one = _mm256_set1_pd(1.);
+    const __m256d epsilon = _mm256_set1_pd(PERIODICITY_EPSILON);
+    const __m256d signMask = _mm256_set1_pd(-0.);
+
+    uint32_t i = 0u;
+
+    for(; i + 4u <= count; i += 4u)
+    {
+        const __m256d x0 = _mm256_loadu_pd(cr + i);
+        const __m256d y0 = _mm256_loadu_pd(ci + i);
+
+        __m256d a = x0, b = y0;
+        __m256d savedA = a, savedB = b;
+        __m256d iterations = _mm256_setzero_pd();
+        __m256d active = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d periodic = _mm256_setzero_pd();
+
+        uint32_t checkpoint = 1u;
+
+        for(uint32_t iteration = 0u; iteration < maxIterations; ++iteration)
+        {
+            const __m256d ab = _mm256_mul_pd(a, b);
+
+            a = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b)), x0);
+            b = _mm256_add_pd(_mm256_add_pd(ab, ab), y0);
+
+            const __m256d magnitude = _mm256_add_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+
+            active = _mm256_and_pd(active, _mm256_cmp_pd(magnitude, radius, _CMP_LE_OQ));
+
+            if constexpr (periodicity)
+            {
+                const __m256d closeA = _mm256_cmp_pd(_mm256_andnot_pd(signMask, _mm256_sub_pd(a, savedA)), epsilon, _CMP_LT_OQ);
+                const __m256d closeB = _mm256_cmp_pd(_mm256_andnot_pd(signMask, _mm256_sub_pd(b, savedB)), epsilon, _CMP_LT_OQ);
+
+                const __m256d cycle = _mm256_and_pd(active, _mm256_and_pd(closeA, closeB));
+
+                periodic = _mm256_or_pd(periodic, cycle);
+                active = _mm256_andnot_pd(cycle, active);
+
+                if(iteration == checkpoint)
+                {
+                    savedA = a;
+                    savedB = b;
+
+                    checkpoint <<= 1u;
+                }
+            }
+
+            if(_mm256_movemask_pd(active) == 0)
+            {
+                break;
+            }
+
+            iterations = _mm256_add_pd(iterations, _mm256_and_pd(active, one));
+        }
+
+        if constexpr (periodicity)
+        {
+            iterations = _mm256_blendv_pd(iterations, _mm256_set1_pd(static_cast<double>(maxIterations)), periodic);
+        }
+
+        const __m128i result = _mm256_cvttpd_epi32(iterations);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(outIterations + i), result);
+    }
+
+    computeScalar<periodicity>(cr + i, ci + i, count - i, maxIterations, outIterations + i);
+}
+
+template<bool periodicity> MANDELBROT_TARGET("avx512f")
+void MandelbrotKernel::computeAvx512(const double* cr, const double* ci, uint32_t count, uint32_t maxIterations, uint32_t* outIterations)
+{
+    const __m512d radius = _mm512_set1_pd(ESCAPE_RADIUS_SQUARED);
+    const __m512d epsilon = _mm512_set1_pd(PERIODICITY_EPSILON);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    // AVX-512F has no masked 256-bit integer ops, a mask becomes all-ones lanes by testing lane i for bit i
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    uint32_t i = 0u;
+
+    for(; i + 8u <= count; i += 8u)
+    {
+        const __m512d x0 = _mm512_loadu_pd(cr + i);
+        const __m512d y0 = _mm512_loadu_pd(ci + i);
+
+        __m512d a = x0, b = y0;
+        __m512d savedA = a, savedB = b;
+        __m256i iterations = _mm256_setzero_si256();
+        __mmask8 active = 0xFFu;
+        __mmask8 periodic = 0u;
+
+        uint32_t checkpoint = 1u;
+
+        for(uint32_t iteration = 0u; iteration < maxIterations; ++iteration)
+        {
+            const __m512d ab = _mm512_mul_pd(a, b);
+
+            a = _mm512_add_pd(_mm512_sub_pd(_mm512_mul_pd(a, a), _mm512_mul_pd(b, b)), x0);
+            b = _mm512_add_pd(_mm512_add_pd(ab, ab), y0);
+
+            const __m512d magnitude = _mm512_add_pd(_mm512_mul_pd(a, a), _mm512_mul_pd(b, b));
+
+            active = _mm512_mask_cmp_pd_mask(active, magnitude, radius, _CMP_LE_OQ);
+
+            if constexpr (periodicity)
+            {
+                const __mmask8 closeA = _mm512_mask_cmp_pd_mask(active, _mm512_abs_pd(_mm512_sub_pd(a, savedA)), epsilon, _CMP_LT_OQ);
+                const __mmask8 cycle = _mm512_mask_cmp_pd_mask(closeA, _mm512_abs_pd(_mm512_sub_pd(b, savedB)), epsilon, _CMP_LT_OQ);
+
+                periodic |= cycle;
+                active &= static_cast<__mmask8>(~cycle);
+
+                if(iteration == checkpoint)
+                {
+                    savedA = a;
+                    savedB = b;
+
+                    checkpoint <<= 1u;
+                }
+            }
+
+            if(active == 0u)
+            {
+                break;
+            }
+
+            const __m256i activeLanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(active), laneBits), laneBits);
+
+            iterations = _mm256_add_epi32(iterations, _mm256_and_si256(activeLanes, one));
+        }
+
+        if constexpr (periodicity)
+        {
+            const __m256i limit = _mm256_set1_epi32(static_cast<int>(maxIterations));
+
+            const __m256i periodicLanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(periodic), laneBits), laneBits);
+
+            iterations = _mm256_or_si256(_mm256_and_si256(periodicLanes, limit), _mm256_andnot_si256(periodicLanes, iterations));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outIterations + i), iterations);
+    }
+
+    computeScalar<periodicity>(cr + i, ci + i, count - i, maxIterations, outIterations + i);
+}
+
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC pop_options
+#endif
\ No newline at end of file
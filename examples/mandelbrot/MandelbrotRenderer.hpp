@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ThreadPool.hpp>
+#include <TaskCoalescer.hpp>
+
+#include <atomic>
+#include <future>
+#include <optional>
+#include <vector>
+
+#include "MandelbrotKernel.hpp"
+#include "PixelBuffer.hpp"
+
+using ldouble = long double;
+
+class MandelbrotRenderer
+{
+    public:
+
+        static void init() { s_instance = new MandelbrotRenderer{}; }
+
+        static void deinit() { delete s_instance; }
+
+        static void setThreadPool(ThreadPool* pool);
+
+        static ThreadPool* getThreadPool();
+
+        static void setIterations(uint32_t iterations);
+
+        static uint32_t getIterations();
+
+        static void setTileSize(uint32_t tileSize);
+
+        static uint32_t getTileSize();
+
+        static void setLeftEdge(ldouble leftEdge);
+
+        static void setRightEdge(ldouble rightEdge);
+
+        static void setTopEdge(ldouble topEdge);
+
+        static void setBottomEdge(ldouble bottomEdge);
+
+        static ldouble getLeftEdge();
+
+        static ldouble getRightEdge();
+
+        static ldouble getTopEdge();
+
+        static ldouble getBottomEdge();
+
+        inline static const ldouble map(ldouble val, ldouble a0, ldouble b0, ldouble a1, ldouble b1);
+
+        static const Color calculateMandelbrotColor(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+        static uint32_t calculateIterations(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+        static const Color colorFromIterations(uint32_t iteration);
+
+        enum class BatchingStrategy
+        {
+            DISABLE_BATCHING,
+            ENABLE_BATCHING,
+            // square tiles written row by row, scheduled along a Morton curve
+            TILED,
+            // Mariani-Silver: rectangles with a uniform border are filled, others split into four nested tasks
+            SUBDIVISION
+        };
+
+        enum class ThreadingStrategy
+        {
+            DISABLE_THREADPOOL,
+            ENABLE_THREADPOOL
+        };
+
+        enum class KernelStrategy
+        {
+            // one pixel at a time in long double
+            SCALAR,
+            // MandelbrotKernel batches in double, long double only once the zoom outruns double precision
+            VECTORIZED
+        };
+
+        static void setKernelStrategy(KernelStrategy kernelStrategy);
+
+        static KernelStrategy getKernelStrategy();
+
+        // cardioid / period-2 bulb membership and orbit periodicity tests, applies to every kernel strategy
+        static void setInteriorShortcuts(bool enabled);
+
+        static bool getInteriorShortcuts();
+
+        // DISABLE_BATCHING on the pool packs the per-pixel tasks through a TaskCoalescer
+        static void setTaskCoalescing(bool enabled);
+
+        static bool getTaskCoalescing();
+
+        // true when neighbouring pixels are no longer distinguishable in double precision
+        static bool requiresExtendedPrecision(uint32_t width, uint32_t height);
+
+        template<BatchingStrategy batchingStrategy = BatchingStrategy::DISABLE_BATCHING,
+                 ThreadingStrategy threadingStrategy = ThreadingStrategy::DISABLE_THREADPOOL>
+        static void render(PixelBuffer& inoutImage);
+
+        // renders [x0, x1) x [y0, y1) with the selected kernel
+        static void renderRect(PixelBuffer& inoutImage, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+        // renders the outTile-sized region at (x0, y0) of an imageWidth x imageHeight image into outTile
+        static void renderTile(PixelBuffer& outTile, uint32_t imageWidth, uint32_t imageHeight, uint32_t x0, uint32_t y0);
+
+        // tile origins of the image in Morton (Z-curve) order
+        static std::vector<std::pair<uint32_t, uint32_t>> makeTiles(uint32_t width, uint32_t height);
+
+    private:
+
+        MandelbrotRenderer() = default;
+
+        static uint64_t mortonCode(uint32_t x, uint32_t y);
+
+        // pixel (x, y) of the imageWidth x imageHeight image lands at (x - originX, y - originY) of outTarget
+        static void renderRegion(PixelBuffer& outTarget, uint32_t originX, uint32_t originY, uint32_t imageWidth, uint32_t imageHeight,
+                                 uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+        // outstanding subdivision tasks of one render, the last one to finish releases the caller
+        struct SubdivisionJoin
+        {
+            std::atomic<uint32_t> pending{1u};
+
+            std::promise<void> done;
+        };
+
+        // below this size a rectangle is rendered directly
+        static constexpr uint32_t SUBDIVISION_MIN_SIZE = 8u;
+
+        // smaller rectangles are subdivided inline instead of becoming a task of their own
+        static constexpr uint32_t SUBDIVISION_TASK_AREA = 32u * 32u;
+
+        static void renderSubdivided(PixelBuffer& inoutImage, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, SubdivisionJoin* join);
+
+        static void finishSubdivision(SubdivisionJoin* join);
+
+        // iteration counts for a list of pixels with the selected kernel
+        static void calculateIterations(const PixelBuffer& image, const uint32_t* xs, const uint32_t* ys, uint32_t count, uint32_t* outIterations);
+
+        inline static MandelbrotRenderer* s_instance = nullptr;
+
+        ThreadPool* m_pool = nullptr;
+
+        uint32_t m_iterations = 1000u;
+
+        uint32_t m_tileSize = 64u;
+
+        KernelStrategy m_kernelStrategy = KernelStrategy::SCALAR;
+
+        bool m_interiorShortcuts = false;
+
+        bool m_taskCoalescing = false;
+
+        ldouble m_left = -2.;
+        ldouble m_right = 2.;
+        ldouble m_top = 2.;
+        ldouble m_bottom = -2.;
+};
+
+#include "MandelbrotRenderer.inl"
\ No newline at end of file
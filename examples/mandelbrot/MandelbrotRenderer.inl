@@ -0,0 +1,689 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+inline void MandelbrotRenderer::setThreadPool(ThreadPool* pool)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_pool = pool;
+}
+
+inline ThreadPool* MandelbrotRenderer::getThreadPool()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_pool;
+}
+
+inline void MandelbrotRenderer::setIterations(uint32_t iterations)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_iterations = iterations;
+}
+
+inline uint32_t MandelbrotRenderer::getIterations()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_iterations;
+}
+
+inline void MandelbrotRenderer::setTileSize(uint32_t tileSize)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+    ALWAYS_ASSERT(tileSize > 0u);
+
+    s_instance->m_tileSize = tileSize;
+}
+
+inline uint32_t MandelbrotRenderer::getTileSize()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_tileSize;
+}
+
+inline void MandelbrotRenderer::setKernelStrategy(KernelStrategy kernelStrategy)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_kernelStrategy = kernelStrategy;
+}
+
+inline MandelbrotRenderer::KernelStrategy MandelbrotRenderer::getKernelStrategy()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_kernelStrategy;
+}
+
+inline void MandelbrotRenderer::setInteriorShortcuts(bool enabled)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_interiorShortcuts = enabled;
+}
+
+inline bool MandelbrotRenderer::getInteriorShortcuts()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_interiorShortcuts;
+}
+
+inline void MandelbrotRenderer::setTaskCoalescing(bool enabled)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_taskCoalescing = enabled;
+}
+
+inline bool MandelbrotRenderer::getTaskCoalescing()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_taskCoalescing;
+}
+
+inline void MandelbrotRenderer::setLeftEdge(ldouble leftEdge)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_left = leftEdge;
+}
+
+inline void MandelbrotRenderer::setRightEdge(ldouble rightEdge)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_right = rightEdge;
+}
+
+inline void MandelbrotRenderer::setTopEdge(ldouble topEdge)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_top = topEdge;
+}
+
+inline void MandelbrotRenderer::setBottomEdge(ldouble bottomEdge)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    s_instance->m_bottom = bottomEdge;
+}
+
+inline ldouble MandelbrotRenderer::getLeftEdge()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_left;
+}
+
+inline ldouble MandelbrotRenderer::getRightEdge()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_right;
+}
+
+inline ldouble MandelbrotRenderer::getTopEdge()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_top;
+}
+
+inline ldouble MandelbrotRenderer::getBottomEdge()
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    return s_instance->m_bottom;
+}
+
+template<MandelbrotRenderer::BatchingStrategy batchingStrategy,
+         MandelbrotRenderer::ThreadingStrategy threadingStrategy>
+void MandelbrotRenderer::render(PixelBuffer& inoutImage)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    const auto imageSize = inoutImage.getSize();
+
+    if constexpr (threadingStrategy == ThreadingStrategy::ENABLE_THREADPOOL)
+    {
+        ALWAYS_ASSERT(s_instance->m_pool != nullptr && "<-- assert missed setThreadPool call");
+
+        s_instance->m_pool->resume();
+    }
+
+    if constexpr (batchingStrategy == BatchingStrategy::DISABLE_BATCHING)
+    {
+        if constexpr (threadingStrategy == ThreadingStrategy::DISABLE_THREADPOOL)
+        {
+            for(uint32_t x = 0u; x < imageSize.x; ++x)
+            {
+                renderRect(inoutImage, x, 0u, x + 1u, imageSize.y);
+            }
+        }
+
+        if constexpr (threadingStrategy == ThreadingStrategy::ENABLE_THREADPOOL)
+        {
+            ThreadPool::FunctionWrapper::Ptr onCompleteTask;
+
+            auto onComplete = ThreadPool::wrapTask([]() -> bool { return true; }, onCompleteTask);
+
+            ThreadPool::Barrier* barrier = new ThreadPool::Barrier{imageSize.x * imageSize.y, std::move(onCompleteTask)};
+
+            std::optional<TaskCoalescer> coalescer;
+
+            if(s_instance->m_taskCoalescing)
+            {
+                coalescer.emplace(*s_instance->m_pool);
+            }
+
+            // one task per pixel, created as the pool drains them so a bounded pool keeps memory flat
+            for(uint32_t x = 0u; x < imageSize.x; ++x)
+            {
+                for(uint32_t y = 0u; y < imageSize.y; ++y)
+                {
+                    auto task = std::make_unique<ThreadPool::FunctionWrapper>
+                    (
+                        [x, y, &inoutImage]() -> void
+                        {
+                            renderRect(inoutImage, x, y, x + 1u, y + 1u);
+                        }
+                    );
+
+                    task->barrier() = barrier;
+
+                    if(coalescer)
+                    {
+                        coalescer->submit(std::move(task));
+                    }
+                    else
+                    {
+                        s_instance->m_pool->submit(std::move(task));
+                    }
+                }
+            }
+
+            // flushes the last partial batch
+            coalescer.reset();
+
+            onComplete.get();
+        }
+
+        return;
+    }
+
+    if constexpr (batchingStrategy == BatchingStrategy::ENABLE_BATCHING)
+    {
+        if constexpr (threadingStrategy == ThreadingStrategy::DISABLE_THREADPOOL)
+        {
+            render<BatchingStrategy::DISABLE_BATCHING, ThreadingStrategy::DISABLE_THREADPOOL>(inoutImage);
+        }
+
+        if constexpr (threadingStrategy == ThreadingStrategy::ENABLE_THREADPOOL)
+        {
+            uint32_t numBatches = std::min(100u, imageSize.x);
+
+            uint32_t batchWidth = imageSize.x / numBatches;
+
+            std::vector<ThreadPool::FunctionWrapper::Ptr> tasks;
+            tasks.reserve(numBatches);
+
+            for(uint32_t batchID = 0u; batchID < numBatches; ++batchID)
+            {
+                // the last batch also takes the columns left over by the integer division
+                uint32_t batchEnd = batchID + 1u == numBatches ? imageSize.x : batchWidth * (batchID + 1u);
+
+                tasks.push_back
+                (
+                    std::make_unique<ThreadPool::FunctionWrapper>
+                    (
+                        [batchID, batchWidth, batchEnd, imageSize, &inoutImage]() -> void
+                        {
+                            for(uint32_t x = batchID * batchWidth; x < batchEnd; ++x)
+                            {
+                                renderRect(inoutImage, x, 0u, x + 1u, imageSize.y);
+                            }
+                        }
+                    )
+                );
+            }
+
+            auto onComplete = s_instance->m_pool->addTasksWithBarrier(std::move(tasks), []() -> bool { return true; });
+            onComplete.get();
+        }
+    }
+
+    if constexpr (batchingStrategy == BatchingStrategy::TILED)
+    {
+        const uint32_t tileSize = s_instance->m_tileSize;
+
+        const auto tiles = makeTiles(imageSize.x, imageSize.y);
+
+        if constexpr (threadingStrategy == ThreadingStrategy::DISABLE_THREADPOOL)
+        {
+            for(const auto& tile : tiles)
+            {
+                renderRect(inoutImage, tile.first, tile.second, std::min(tile.first + tileSize, imageSize.x), std::min(tile.second + tileSize, imageSize.y));
+            }
+        }
+
+        if constexpr (threadingStrategy == ThreadingStrategy::ENABLE_THREADPOOL)
+        {
+            std::vector<ThreadPool::FunctionWrapper::Ptr> tasks;
+            tasks.reserve(tiles.size());
+
+            for(const auto& tile : tiles)
+            {
+                const uint32_t x1 = std::min(tile.first + tileSize, imageSize.x);
+                const uint32_t y1 = std::min(tile.second + tileSize, imageSize.y);
+
+                tasks.push_back
+                (
+                    std::make_unique<ThreadPool::FunctionWrapper>
+                    (
+                        [tile, x1, y1, &inoutImage]() -> void
+                        {
+                            renderRect(inoutImage, tile.first, tile.second, x1, y1);
+                        }
+                    )
+                );
+            }
+
+            auto onComplete = s_instance->m_pool->addTasksWithBarrier(std::move(tasks), []() -> bool { return true; });
+            onComplete.get();
+        }
+    }
+
+    if constexpr (batchingStrategy == BatchingStrategy::SUBDIVISION)
+    {
+        if constexpr (threadingStrategy == ThreadingStrategy::DISABLE_THREADPOOL)
+        {
+            renderSubdivided(inoutImage, 0u, 0u, imageSize.x, imageSize.y, nullptr);
+        }
+
+        if constexpr (threadingStrategy == ThreadingStrategy::ENABLE_THREADPOOL)
+        {
+            SubdivisionJoin join;
+
+            auto onComplete = join.done.get_future();
+
+            s_instance->m_pool->executeAsync
+            (
+                std::make_unique<ThreadPool::FunctionWrapper>
+                (
+                    [imageSize, &inoutImage, &join]() -> void
+                    {
+                        renderSubdivided(inoutImage, 0u, 0u, imageSize.x, imageSize.y, &join);
+
+                        finishSubdivision(&join);
+                    }
+                )
+            );
+
+            onComplete.get();
+        }
+    }
+}
+
+inline void MandelbrotRenderer::finishSubdivision(SubdivisionJoin* join)
+{
+    if(join->pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+    {
+        join->done.set_value();
+    }
+}
+
+inline void MandelbrotRenderer::calculateIterations(const PixelBuffer& image, const uint32_t* xs, const uint32_t* ys, uint32_t count, uint32_t* outIterations)
+{
+    const auto imageSize = image.getSize();
+
+    if(s_instance->m_kernelStrategy == KernelStrategy::SCALAR || requiresExtendedPrecision(imageSize.x, imageSize.y))
+    {
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            outIterations[i] = calculateIterations(xs[i], ys[i], imageSize.x, imageSize.y);
+        }
+
+        return;
+    }
+
+    // scratch memory of the current worker, released with the task
+    std::pmr::vector<double> cr(count, ThreadPool::scratchResource()), ci(count, ThreadPool::scratchResource());
+
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        cr[i] = static_cast<double>(map(static_cast<ldouble>(xs[i]), 0., static_cast<ldouble>(imageSize.x), s_instance->m_left, s_instance->m_right));
+        ci[i] = static_cast<double>(map(static_cast<ldouble>(ys[i]), 0., static_cast<ldouble>(imageSize.y), s_instance->m_bottom, s_instance->m_top));
+    }
+
+    MandelbrotKernel::computeIterations(cr.data(), ci.data(), count, s_instance->m_iterations, outIterations, s_instance->m_interiorShortcuts);
+}
+
+inline void MandelbrotRenderer::renderSubdivided(PixelBuffer& inoutImage, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, SubdivisionJoin* join)
+{
+    if(x1 - x0 <= SUBDIVISION_MIN_SIZE || y1 - y0 <= SUBDIVISION_MIN_SIZE)
+    {
+        renderRect(inoutImage, x0, y0, x1, y1);
+
+        return;
+    }
+
+    // the border: top and bottom rows, then the left and right columns between them
+    std::pmr::vector<uint32_t> xs{ThreadPool::scratchResource()}, ys{ThreadPool::scratchResource()};
+
+    const size_t borderSize = 2u * (x1 - x0) + 2u * (y1 - y0 - 2u);
+
+    xs.reserve(borderSize);
+    ys.reserve(borderSize);
+
+    for(uint32_t x = x0; x < x1; ++x)
+    {
+        xs.push_back(x); ys.push_back(y0);
+        xs.push_back(x); ys.push_back(y1 - 1u);
+    }
+
+    for(uint32_t y = y0 + 1u; y < y1 - 1u; ++y)
+    {
+        xs.push_back(x0); ys.push_back(y);
+        xs.push_back(x1 - 1u); ys.push_back(y);
+    }
+
+    std::pmr::vector<uint32_t> iterations(xs.size(), ThreadPool::scratchResource());
+
+    calculateIterations(inoutImage, xs.data(), ys.data(), static_cast<uint32_t>(xs.size()), iterations.data());
+
+    bool uniform = true;
+
+    for(size_t i = 0u; i < xs.size(); ++i)
+    {
+        inoutImage.setPixel(xs[i], ys[i], colorFromIterations(iterations[i]));
+
+        uniform = uniform && iterations[i] == iterations[0];
+    }
+
+    if(uniform)
+    {
+        const Color color = colorFromIterations(iterations[0]);
+
+        for(uint32_t y = y0 + 1u; y < y1 - 1u; ++y)
+        {
+            for(uint32_t x = x0 + 1u; x < x1 - 1u; ++x)
+            {
+                inoutImage.setPixel(x, y, color);
+            }
+        }
+
+        return;
+    }
+
+    // the border is done, so the four quadrants only cover the interior and never recompute a pixel
+    const uint32_t ix0 = x0 + 1u, iy0 = y0 + 1u, ix1 = x1 - 1u, iy1 = y1 - 1u;
+
+    const uint32_t mx = ix0 + (ix1 - ix0) / 2u, my = iy0 + (iy1 - iy0) / 2u;
+
+    const uint32_t quadrants[4][4] =
+    {
+        {ix0, iy0, mx, my},
+        {mx, iy0, ix1, my},
+        {ix0, my, mx, iy1},
+        {mx, my, ix1, iy1}
+    };
+
+    for(const auto& q : quadrants)
+    {
+        if(q[0] >= q[2] || q[1] >= q[3])
+        {
+            continue;
+        }
+
+        if(join != nullptr && (q[2] - q[0]) * (q[3] - q[1]) >= SUBDIVISION_TASK_AREA)
+        {
+            join->pending.fetch_add(1u, std::memory_order_relaxed);
+
+            s_instance->m_pool->executeAsync
+            (
+                std::make_unique<ThreadPool::FunctionWrapper>
+                (
+                    [q, &inoutImage, join]() -> void
+                    {
+                        renderSubdivided(inoutImage, q[0], q[1], q[2], q[3], join);
+
+                        finishSubdivision(join);
+                    }
+                )
+            );
+        }
+        else
+        {
+            renderSubdivided(inoutImage, q[0], q[1], q[2], q[3], join);
+        }
+    }
+}
+
+inline uint64_t MandelbrotRenderer::mortonCode(uint32_t x, uint32_t y)
+{
+    auto spread = [](uint64_t value) -> uint64_t
+    {
+        value = (value | (value << 16u)) & 0x0000FFFF0000FFFFull;
+        value = (value | (value << 8u)) & 0x00FF00FF00FF00FFull;
+        value = (value | (value << 4u)) & 0x0F0F0F0F0F0F0F0Full;
+        value = (value | (value << 2u)) & 0x3333333333333333ull;
+        value = (value | (value << 1u)) & 0x5555555555555555ull;
+
+        return value;
+    };
+
+    return spread(x) | (spread(y) << 1u);
+}
+
+inline std::vector<std::pair<uint32_t, uint32_t>> MandelbrotRenderer::makeTiles(uint32_t width, uint32_t height)
+{
+    const uint32_t tileSize = s_instance->m_tileSize;
+
+    const uint32_t tilesX = (width + tileSize - 1u) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1u) / tileSize;
+
+    std::vector<std::pair<uint64_t, std::pair<uint32_t, uint32_t>>> ordered;
+    ordered.reserve(static_cast<size_t>(tilesX) * tilesY);
+
+    for(uint32_t ty = 0u; ty < tilesY; ++ty)
+    {
+        for(uint32_t tx = 0u; tx < tilesX; ++tx)
+        {
+            ordered.push_back({mortonCode(tx, ty), {tx * tileSize, ty * tileSize}});
+        }
+    }
+
+    std::sort(ordered.begin(), ordered.end());
+
+    std::vector<std::pair<uint32_t, uint32_t>> tiles;
+    tiles.reserve(ordered.size());
+
+    for(const auto& tile : ordered)
+    {
+        tiles.push_back(tile.second);
+    }
+
+    return tiles;
+}
+
+inline const ldouble MandelbrotRenderer::map(ldouble val, ldouble a0, ldouble b0, ldouble a1, ldouble b1)
+{
+    return a1 + (val - a0) * (b1 - a1) / (b0 - a0);
+}
+
+inline const Color MandelbrotRenderer::calculateMandelbrotColor(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    return colorFromIterations(calculateIterations(x, y, width, height));
+}
+
+inline uint32_t MandelbrotRenderer::calculateIterations(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    ldouble a = map(static_cast<ldouble>(x), 0., static_cast<ldouble>(width), s_instance->m_left, s_instance->m_right);
+    ldouble b = map(static_cast<ldouble>(y), 0., static_cast<ldouble>(height), s_instance->m_bottom, s_instance->m_top);
+
+    ldouble ca = a, cb = b;
+
+    const bool shortcuts = s_instance->m_interiorShortcuts;
+
+    if(shortcuts && MandelbrotKernel::isInsideMainBulbs(ca, cb))
+    {
+        return s_instance->m_iterations;
+    }
+
+    ldouble savedA = a, savedB = b;
+
+    uint32_t checkpoint = 1u;
+
+    uint32_t iteration = 0u;
+
+    for(; iteration < s_instance->m_iterations; ++iteration)
+    {
+        ldouble aa = a*a - b*b, bb = 2 * a*b;
+        a = aa + ca;
+        b = bb + cb;
+
+        if(a*a + b*b > MandelbrotKernel::ESCAPE_RADIUS_SQUARED)
+        {
+            break;
+        }
+
+        if(shortcuts)
+        {
+            if(std::abs(a - savedA) < MandelbrotKernel::PERIODICITY_EPSILON && std::abs(b - savedB) < MandelbrotKernel::PERIODICITY_EPSILON)
+            {
+                return s_instance->m_iterations;
+            }
+
+            if(iteration == checkpoint)
+            {
+                savedA = a;
+                savedB = b;
+
+                checkpoint <<= 1u;
+            }
+        }
+    }
+
+    return iteration;
+}
+
+inline const Color MandelbrotRenderer::colorFromIterations(uint32_t iteration)
+{
+    uint8_t brightness = static_cast<uint8_t>(map(static_cast<ldouble>(iteration), 0., s_instance->m_iterations, 0., 255.));
+
+    uint32_t brightness2 = brightness * brightness;
+
+    uint64_t brightness4 = brightness2 * brightness2;
+
+    Color result{ brightness, static_cast<uint8_t>(brightness2 % 255u), static_cast<uint8_t>(brightness4 % 255u) };
+
+    return result;
+}
+
+inline bool MandelbrotRenderer::requiresExtendedPrecision(uint32_t width, uint32_t height)
+{
+    ALWAYS_ASSERT(s_instance != nullptr && "<-- assert missed init call");
+
+    const ldouble pixelSize = std::min((s_instance->m_right - s_instance->m_left) / width, (s_instance->m_top - s_instance->m_bottom) / height);
+
+    const ldouble magnitude = std::max({std::abs(s_instance->m_left), std::abs(s_instance->m_right), std::abs(s_instance->m_top), std::abs(s_instance->m_bottom), ldouble{1.}});
+
+    // keep a few bits of headroom over double's 52 bit mantissa for the iteration to stay stable
+    return pixelSize < magnitude * std::ldexp(ldouble{1.}, -44);
+}
+
+inline void MandelbrotRenderer::renderRect(PixelBuffer& inoutImage, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    const auto imageSize = inoutImage.getSize();
+
+    renderRegion(inoutImage, 0u, 0u, imageSize.x, imageSize.y, x0, y0, x1, y1);
+}
+
+inline void MandelbrotRenderer::renderTile(PixelBuffer& outTile, uint32_t imageWidth, uint32_t imageHeight, uint32_t x0, uint32_t y0)
+{
+    const auto tileSize = outTile.getSize();
+
+    renderRegion(outTile, x0, y0, imageWidth, imageHeight, x0, y0, x0 + tileSize.x, y0 + tileSize.y);
+}
+
+inline void MandelbrotRenderer::renderRegion(PixelBuffer& outTarget, uint32_t originX, uint32_t originY, uint32_t imageWidth, uint32_t imageHeight,
+                                             uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    const PixelBuffer::Size imageSize{imageWidth, imageHeight};
+
+    if(s_instance->m_kernelStrategy == KernelStrategy::SCALAR || requiresExtendedPrecision(imageSize.x, imageSize.y))
+    {
+        for(uint32_t y = y0; y < y1; ++y)
+        {
+            for(uint32_t x = x0; x < x1; ++x)
+            {
+                outTarget.setPixel(x - originX, y - originY, calculateMandelbrotColor(x, y, imageSize.x, imageSize.y));
+            }
+        }
+
+        return;
+    }
+
+    constexpr uint32_t CHUNK_SIZE = 256u;
+
+    double cr[CHUNK_SIZE], ci[CHUNK_SIZE];
+
+    uint32_t iterations[CHUNK_SIZE];
+
+    uint32_t pending = 0u;
+
+    // pixels are gathered in the same order they are written back, so the scatter needs no coordinates
+    auto flush = [&](uint32_t lastX, uint32_t lastY) -> void
+    {
+        MandelbrotKernel::computeIterations(cr, ci, pending, s_instance->m_iterations, iterations, s_instance->m_interiorShortcuts);
+
+        uint32_t x = lastX, y = lastY;
+
+        for(uint32_t i = pending; i-- > 0u;)
+        {
+            outTarget.setPixel(x - originX, y - originY, colorFromIterations(iterations[i]));
+
+            if(x == x0)
+            {
+                x = x1;
+
+                --y;
+            }
+
+            --x;
+        }
+
+        pending = 0u;
+    };
+
+    for(uint32_t y = y0; y < y1; ++y)
+    {
+        const double imaginary = static_cast<double>(map(static_cast<ldouble>(y), 0., static_cast<ldouble>(imageSize.y), s_instance->m_bottom, s_instance->m_top));
+
+        for(uint32_t x = x0; x < x1; ++x)
+        {
+            cr[pending] = static_cast<double>(map(static_cast<ldouble>(x), 0., static_cast<ldouble>(imageSize.x), s_instance->m_left, s_instance->m_right));
+            ci[pending] = imaginary;
+
+            if(++pending == CHUNK_SIZE)
+            {
+                flush(x, y);
+            }
+        }
+    }
+
+    if(pending > 0u)
+    {
+        flush(x1 - 1u, y1 - 1u);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "PixelBuffer.hpp"
+
+// Binary PPM (P6) backed by a memory-mapped file, for images larger than memory.
+// The header is written up front, pixels go straight into the mapping and flushRows
+// writes finished rows back and drops them from the working set.
+class MappedImage
+{
+    public:
+
+        MappedImage() = default;
+
+        MappedImage(const MappedImage&) = delete;
+
+        MappedImage& operator=(const MappedImage&) = delete;
+
+       ~MappedImage() { close(); }
+
+        // creates or truncates path to the full image size
+        bool create(const std::string& path, uint32_t width, uint32_t height);
+
+        // unmaps and closes the file, pending pages are written back by the OS
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+
+        PixelBuffer::Size getSize() const { return m_size; }
+
+        // copies an RGBA tile to (x0, y0), alpha is dropped; tiles may be written concurrently
+        void writeTile(const PixelBuffer& tile, uint32_t x0, uint32_t y0);
+
+        // writes rows [y0, y1) to the file and releases their pages
+        void flushRows(uint32_t y0, uint32_t y1);
+
+    private:
+
+        uint8_t* rowPtr(uint32_t y) { return m_data + m_headerSize + static_cast<size_t>(y) * m_size.x * 3u; }
+
+        PixelBuffer::Size m_size;
+
+        uint8_t* m_data = nullptr;
+
+        size_t m_fileSize = 0u;
+
+        size_t m_headerSize = 0u;
+
+#if defined(_WIN32)
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_file = -1;
+#endif
+};
+
+#include "MappedImage.inl"
\ No newline at end of file
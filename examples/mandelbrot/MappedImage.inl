@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+inline bool MappedImage::create(const std::string& path, uint32_t width, uint32_t height)
+{
+    close();
+
+    const std::string header = "P6\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+
+    m_size = PixelBuffer::Size{width, height};
+
+    m_headerSize = header.size();
+
+    m_fileSize = m_headerSize + static_cast<size_t>(width) * height * 3u;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    m_file = file;
+
+    const DWORD sizeHigh = static_cast<DWORD>(static_cast<uint64_t>(m_fileSize) >> 32u);
+    const DWORD sizeLow = static_cast<DWORD>(m_fileSize);
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, sizeHigh, sizeLow, nullptr);
+
+    if(m_mapping == nullptr)
+    {
+        close();
+
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, m_fileSize));
+#else
+    m_file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if(m_file < 0)
+    {
+        return false;
+    }
+
+    // sparse until written, so creating a huge file is instant
+    if(::ftruncate(m_file, static_cast<off_t>(m_fileSize)) != 0)
+    {
+        close();
+
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, m_fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+
+    m_data = data == MAP_FAILED ? nullptr : static_cast<uint8_t*>(data);
+#endif
+
+    if(m_data == nullptr)
+    {
+        close();
+
+        return false;
+    }
+
+    std::memcpy(m_data, header.data(), m_headerSize);
+
+    return true;
+}
+
+inline void MappedImage::close()
+{
+#if defined(_WIN32)
+    if(m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if(m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    if(m_file != nullptr)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if(m_data != nullptr)
+    {
+        ::munmap(m_data, m_fileSize);
+    }
+
+    if(m_file >= 0)
+    {
+        ::close(m_file);
+    }
+
+    m_file = -1;
+#endif
+
+    m_data = nullptr;
+}
+
+inline void MappedImage::writeTile(const PixelBuffer& tile, uint32_t x0, uint32_t y0)
+{
+    const PixelBuffer::Size tileSize = tile.getSize();
+
+    ALWAYS_ASSERT(x0 + tileSize.x <= m_size.x && y0 + tileSize.y <= m_size.y);
+
+    const uint8_t* source = tile.getPixelsPtr();
+
+    for(uint32_t y = 0u; y < tileSize.y; ++y)
+    {
+        uint8_t* destination = rowPtr(y0 + y) + static_cast<size_t>(x0) * 3u;
+
+        for(uint32_t x = 0u; x < tileSize.x; ++x, source += 4u, destination += 3u)
+        {
+            destination[0] = source[0];
+            destination[1] = source[1];
+            destination[2] = source[2];
+        }
+    }
+}
+
+inline void MappedImage::flushRows(uint32_t y0, uint32_t y1)
+{
+    if(y0 >= y1)
+    {
+        return;
+    }
+
+    uint8_t* begin = y0 == 0u ? m_data : rowPtr(y0);
+    uint8_t* end = y1 == m_size.y ? m_data + m_fileSize : rowPtr(y1);
+
+#if defined(_WIN32)
+    FlushViewOfFile(begin, static_cast<size_t>(end - begin));
+
+    // unlocking pages that are not locked trims them from the working set
+    VirtualUnlock(begin, static_cast<size_t>(end - begin));
+#else
+    const uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+
+    // whole pages only: the page shared with the next rows stays mapped until those rows are flushed
+    const uintptr_t alignedBegin = reinterpret_cast<uintptr_t>(begin) & ~(pageSize - 1u);
+    const uintptr_t alignedEnd = y1 == m_size.y ? reinterpret_cast<uintptr_t>(end) : reinterpret_cast<uintptr_t>(end) & ~(pageSize - 1u);
+
+    if(alignedEnd <= alignedBegin)
+    {
+        return;
+    }
+
+    void* address = reinterpret_cast<void*>(alignedBegin);
+
+    const size_t length = static_cast<size_t>(alignedEnd - alignedBegin);
+
+    ::msync(address, length, MS_SYNC);
+
+    // the data is on disk now, only the process' copy of the pages goes away
+    ::madvise(address, length, MADV_DONTNEED);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct Color
+{
+    uint8_t r = 0u;
+    uint8_t g = 0u;
+    uint8_t b = 0u;
+    uint8_t a = 255u;
+};
+
+// Row-major RGBA8 image, API mirrors the parts of sf::Image the renderer uses
+class PixelBuffer
+{
+    public:
+
+        struct Size
+        {
+            uint32_t x = 0u;
+            uint32_t y = 0u;
+        };
+
+        PixelBuffer() = default;
+
+        PixelBuffer(uint32_t width, uint32_t height, Color fill = Color{}) { create(width, height, fill); }
+
+        void create(uint32_t width, uint32_t height, Color fill = Color{})
+        {
+            m_size = Size{width, height};
+
+            m_pixels.resize(static_cast<size_t>(width) * height * 4u);
+
+            for(size_t i = 0u; i < m_pixels.size(); i += 4u)
+            {
+                m_pixels[i] = fill.r;
+                m_pixels[i + 1u] = fill.g;
+                m_pixels[i + 2u] = fill.b;
+                m_pixels[i + 3u] = fill.a;
+            }
+        }
+
+        Size getSize() const { return m_size; }
+
+        void setPixel(uint32_t x, uint32_t y, Color color)
+        {
+            uint8_t* pixel = &m_pixels[(static_cast<size_t>(y) * m_size.x + x) * 4u];
+
+            pixel[0] = color.r;
+            pixel[1] = color.g;
+            pixel[2] = color.b;
+            pixel[3] = color.a;
+        }
+
+        Color getPixel(uint32_t x, uint32_t y) const
+        {
+            const uint8_t* pixel = &m_pixels[(static_cast<size_t>(y) * m_size.x + x) * 4u];
+
+            return Color{pixel[0], pixel[1], pixel[2], pixel[3]};
+        }
+
+        const uint8_t* getPixelsPtr() const { return m_pixels.data(); }
+
+        // copies [x0, x1) x [y0, y1) into a tightly packed RGBA8 block, e.g. for a partial texture upload
+        void copyRect(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, std::vector<uint8_t>& outPixels) const
+        {
+            const size_t rowBytes = static_cast<size_t>(x1 - x0) * 4u;
+
+            outPixels.resize(rowBytes * (y1 - y0));
+
+            for(uint32_t y = y0; y < y1; ++y)
+            {
+                std::copy_n(&m_pixels[(static_cast<size_t>(y) * m_size.x + x0) * 4u], rowBytes, &outPixels[rowBytes * (y - y0)]);
+            }
+        }
+
+        // binary P6, alpha is dropped
+        bool saveToPpm(const std::string& path) const
+        {
+            std::ofstream out{path, std::ios::binary};
+
+            if(!out)
+            {
+                return false;
+            }
+
+            out << "P6\n" << m_size.x << ' ' << m_size.y << "\n255\n";
+
+            std::vector<uint8_t> row(static_cast<size_t>(m_size.x) * 3u);
+
+            for(uint32_t y = 0u; y < m_size.y; ++y)
+            {
+                for(uint32_t x = 0u; x < m_size.x; ++x)
+                {
+                    const uint8_t* pixel = &m_pixels[(static_cast<size_t>(y) * m_size.x + x) * 4u];
+
+                    row[x * 3u] = pixel[0];
+                    row[x * 3u + 1u] = pixel[1];
+                    row[x * 3u + 2u] = pixel[2];
+                }
+
+                out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+            }
+
+            return static_cast<bool>(out);
+        }
+
+    private:
+
+        Size m_size;
+
+        std::vector<uint8_t> m_pixels;
+};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MandelbrotRenderer.hpp"
+#include "MappedImage.hpp"
+
+// Renders images of any size straight into a memory-mapped PPM. Tiles are issued row of tiles by row
+// of tiles with a bounded number in flight, each worker renders into its own tile-sized buffer, and
+// completed rows of tiles are flushed and dropped from memory in order. The working set is a few rows
+// of tiles wide, independent of the image height. Settings come from MandelbrotRenderer, deep zoom is
+// not supported.
+class StreamingRenderer
+{
+    public:
+
+        template<MandelbrotRenderer::ThreadingStrategy threadingStrategy = MandelbrotRenderer::ThreadingStrategy::DISABLE_THREADPOOL>
+        static bool render(const std::string& path, uint32_t width, uint32_t height, uint32_t maxTilesInFlight = 64u);
+
+    private:
+
+        // renders and stores the tile at (x0, y0), the buffer is reused per thread
+        static void renderTile(MappedImage& outImage, uint32_t x0, uint32_t y0);
+
+        struct Progress
+        {
+            std::mutex mut;
+
+            std::condition_variable cv;
+
+            uint32_t tilesInFlight = 0u;
+
+            // unfinished tiles per row of tiles
+            std::vector<uint32_t> pendingPerRow;
+        };
+};
+
+#include "StreamingRenderer.inl"
\ No newline at end of file
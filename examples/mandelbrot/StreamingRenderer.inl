@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+
+template<MandelbrotRenderer::ThreadingStrategy threadingStrategy>
+bool StreamingRenderer::render(const std::string& path, uint32_t width, uint32_t height, uint32_t maxTilesInFlight)
+{
+    ALWAYS_ASSERT(maxTilesInFlight > 0u);
+
+    ALWAYS_ASSERT(width > 0u && height > 0u && "<-- assert zero-sized image");
+
+    MappedImage image;
+
+    if(!image.create(path, width, height))
+    {
+        return false;
+    }
+
+    const uint32_t tileSize = MandelbrotRenderer::getTileSize();
+
+    const uint32_t tilesX = (width + tileSize - 1u) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1u) / tileSize;
+
+    if constexpr (threadingStrategy == MandelbrotRenderer::ThreadingStrategy::DISABLE_THREADPOOL)
+    {
+        for(uint32_t row = 0u; row < tilesY; ++row)
+        {
+            for(uint32_t column = 0u; column < tilesX; ++column)
+            {
+                renderTile(image, column * tileSize, row * tileSize);
+            }
+
+            image.flushRows(row * tileSize, std::min((row + 1u) * tileSize, height));
+        }
+    }
+
+    if constexpr (threadingStrategy == MandelbrotRenderer::ThreadingStrategy::ENABLE_THREADPOOL)
+    {
+        Progress progress;
+
+        progress.pendingPerRow.assign(tilesY, tilesX);
+
+        // workers run their newest task first, so the oldest tile of a row may wait until no more tiles arrive.
+        // Bounding rows as well as tiles guarantees the front row completes and the working set stays put.
+        const uint32_t rowWindow = std::max(2u, maxTilesInFlight / tilesX);
+
+        uint32_t completedRows = 0u, flushedRows = 0u;
+
+        // the caller holds the lock
+        auto advanceCompleted = [&]() -> uint32_t
+        {
+            while(completedRows < tilesY && progress.pendingPerRow[completedRows] == 0u)
+            {
+                ++completedRows;
+            }
+
+            return completedRows;
+        };
+
+        // flushes the completed rows of tiles at the front, the caller holds the lock
+        auto flushCompleted = [&](std::unique_lock<std::mutex>& lock) -> void
+        {
+            const uint32_t end = advanceCompleted();
+
+            lock.unlock();
+
+            for(; flushedRows < end; ++flushedRows)
+            {
+                image.flushRows(flushedRows * tileSize, std::min((flushedRows + 1u) * tileSize, height));
+            }
+
+            lock.lock();
+        };
+
+        for(uint32_t row = 0u; row < tilesY; ++row)
+        {
+            for(uint32_t column = 0u; column < tilesX; ++column)
+            {
+                {
+                    std::unique_lock<std::mutex> lock{progress.mut};
+
+                    progress.cv.wait(lock, [&]() -> bool { return progress.tilesInFlight < maxTilesInFlight && row < advanceCompleted() + rowWindow; });
+
+                    flushCompleted(lock);
+
+                    ++progress.tilesInFlight;
+                }
+
+                MandelbrotRenderer::getThreadPool()->executeAsync
+                (
+                    std::make_unique<ThreadPool::FunctionWrapper>
+                    (
+                        [&image, &progress, x0 = column * tileSize, y0 = row * tileSize, row]() -> void
+                        {
+                            renderTile(image, x0, y0);
+
+                            // notified under the lock, the final wait may return and destroy progress as soon as
+                            // the lock is released
+                            std::lock_guard<std::mutex> lock{progress.mut};
+
+                            --progress.pendingPerRow[row];
+                            --progress.tilesInFlight;
+
+                            progress.cv.notify_one();
+                        }
+                    )
+                );
+            }
+        }
+
+        std::unique_lock<std::mutex> lock{progress.mut};
+
+        progress.cv.wait(lock, [&progress]() -> bool { return progress.tilesInFlight == 0u; });
+
+        flushCompleted(lock);
+    }
+
+    image.close();
+
+    return true;
+}
+
+inline void StreamingRenderer::renderTile(MappedImage& outImage, uint32_t x0, uint32_t y0)
+{
+    const PixelBuffer::Size imageSize = outImage.getSize();
+
+    const uint32_t tileSize = MandelbrotRenderer::getTileSize();
+
+    const uint32_t tileWidth = std::min(tileSize, imageSize.x - x0);
+    const uint32_t tileHeight = std::min(tileSize, imageSize.y - y0);
+
+    thread_local PixelBuffer tile;
+
+    if(tile.getSize().x != tileWidth || tile.getSize().y != tileHeight)
+    {
+        tile.create(tileWidth, tileHeight);
+    }
+
+    MandelbrotRenderer::renderTile(tile, imageSize.x, imageSize.y, x0, y0);
+
+    outImage.writeTile(tile, x0, y0);
+}
\ No newline at end of file